@@ -20,432 +20,2373 @@
 #include <Arduino.h>
 #include <limits.h>
 
+#ifdef JOYSTICK_SPI
+    #include <SPI.h>
+#endif
+
+#ifdef JOYSTICK_WIRE
+    #include <Wire.h>
+#endif
+
 #define JOYSTICK static_cast<T*>(this)
 
-//#define BIT_RESOLUTION_MAX_VALUE 1023 //10-bit
-#define BIT_RESOLUTION_MAX_VALUE 4095 //12-bit
+struct Joystick_no_filter;
+struct Joystick_every_read;
+struct Joystick_analog_read;
+struct Joystick_button_pins;
+struct Joystick_cached_pins;
+template <class... ENCODERS> struct Joystick_encoders;
+template <class... HATS> struct Joystick_hats;
+template <class... THRESHOLDS> struct Joystick_thresholds;
+
+//Types used by the library; derive from this struct to change them
+struct Joystick_policy
+{
+    typedef uint_fast16_t storage_type; //data_buttons, data_pots and CALIBRATION elements; also the size of each channel sent
+    typedef uint_fast16_t compute_type; //intermediate values
+    typedef Joystick_no_filter filter; //applied to data_pots after every read
+    typedef Joystick_every_read pot_schedule; //potentiometers converted by every read
+    typedef Joystick_analog_read pot_source; //converts the potentiometers
+    typedef Joystick_button_pins button_source; //reads the buttons
+    typedef Joystick_encoders<> encoders; //quadrature encoders sent after the potentiometers
+    typedef Joystick_hats<> hats; //groups of four buttons sent as POV hats
+    typedef Joystick_thresholds<> thresholds; //potentiometers also sent as buttons after the last button
+
+    static constexpr bool inverted(size_t) { return false; } //buttons pulled and read the opposite way of IS_PULL_UP
+
+    static auto port() -> decltype(Serial)& { return Serial; } //carries the frames of send
+    static auto console() -> decltype(Serial)& { return Serial; } //used by print and calibration
+
+    static constexpr bool blocking_send = false; //send waits for room in the port instead of dropping the frame
+    static constexpr uint_fast8_t batch_samples = 1; //samples sent per frame, more than 1 sends batch frames that vJoySerialFeeder cannot read
+
+#ifdef ESP32
+    static constexpr uint_fast8_t adc_bits = 12; //resolution of analogRead, defaulted per board
+#else
+    static constexpr uint_fast8_t adc_bits = 10; //resolution of analogRead, defaulted per board
+#endif
+    static constexpr bool set_adc_bits = true; //calls analogReadResolution(adc_bits) on boards having it
+    static constexpr uint_fast8_t oversample_bits = 0; //extra bits read from every potentiometer by averaging (1 << (2 * oversample_bits)) samples
+    static constexpr uint_fast8_t pot_bits = 12; //resolution of data_pots, the range of every potentiometer channel
+};
+
+//Halves memory, non-volatile memory and frame size on 32-bit boards
+struct Joystick_compact_policy : Joystick_policy
+{
+    typedef uint16_t storage_type;
+};
+
+namespace detail
+{
+    // Primary template.
+    /// Define a member typedef @c type only if a boolean constant is true.
+    template<bool, typename _Tp = void>
+    struct enable_if 
+    { };
+
+    // Partial specialization for true.
+    template<typename _Tp>
+    struct enable_if<true, _Tp>
+    { typedef _Tp type; };
+
+    template<bool, typename _Tp, typename _Fp>
+    struct conditional
+    { typedef _Tp type; };
+
+    template<typename _Tp, typename _Fp>
+    struct conditional<false, _Tp, _Fp>
+    { typedef _Fp type; };
+
+    template<typename _Tp, typename _Up>
+    struct is_same
+    { static constexpr bool value = false; };
+
+    template<typename _Tp>
+    struct is_same<_Tp, _Tp>
+    { static constexpr bool value = true; };
+
+    template <class WORD>
+    constexpr size_t round_to_word(const size_t bits)
+    {
+        return bits % (sizeof(WORD) * CHAR_BIT) ? ((bits/(sizeof(WORD) * CHAR_BIT)) + 1) : (bits/(sizeof(WORD) * CHAR_BIT));
+    }
+
+    constexpr uint_fast8_t bit_width(const uint_fast32_t value)
+    {
+        return value ? (1 + bit_width(value >> 1)) : 0;
+    }
+
+    //Resolution fixed by a pot_source converting with its own ADC, 0 when it converts with analogRead at adc_bits
+    template <class SOURCE>
+    constexpr auto source_adc_bits(int) -> decltype(SOURCE::adc_bits + 0)
+    {
+        return SOURCE::adc_bits;
+    }
+
+    template <class SOURCE>
+    constexpr uint_fast8_t source_adc_bits(long)
+    {
+        return 0;
+    }
+
+    //Whether a pot_source converts in the background between start and collect, so read_pots pipelines its conversions
+    template <class SOURCE>
+    constexpr auto source_asynchronous(int) -> decltype(SOURCE::asynchronous && true)
+    {
+        return SOURCE::asynchronous;
+    }
+
+    template <class SOURCE>
+    constexpr bool source_asynchronous(long)
+    {
+        return false;
+    }
+
+    //Largest value of data_pots
+    template <class POLICY>
+    constexpr uint_fast32_t pot_max()
+    {
+        return (static_cast<uint_fast32_t>(1) << POLICY::pot_bits) - 1;
+    }
+
+    //Packs the potentiometer values for the filters. On 32-bit boards two 16-bit channels share one register
+    //(SIMD within a register) whenever (MAX_VALUE << SHIFT) cannot carry from one channel into the other.
+    template <size_t POTS_SIZE, uint_fast32_t MAX_VALUE, uint_fast8_t SHIFT, bool SWAR = (sizeof(size_t) >= sizeof(uint32_t)) && ((MAX_VALUE << SHIFT) <= 0xFFFF)>
+    struct pot_lanes
+    {
+        typedef typename conditional<((MAX_VALUE << SHIFT) <= 0xFFFF), uint_fast16_t, uint_fast32_t>::type word;
+
+        static constexpr size_t count = 1;
+        static constexpr size_t size = POTS_SIZE;
+        static constexpr word mask = ~static_cast<word>(0);
+
+        template <class STORAGE>
+        static word pack(const STORAGE (&data)[POTS_SIZE], const size_t i) { return data[i]; }
+
+        template <class STORAGE>
+        static void unpack(STORAGE (&data)[POTS_SIZE], const size_t i, const word value) { data[i] = value; }
+    };
+
+    template <size_t POTS_SIZE, uint_fast32_t MAX_VALUE, uint_fast8_t SHIFT>
+    struct pot_lanes<POTS_SIZE, MAX_VALUE, SHIFT, true>
+    {
+        typedef uint32_t word;
+
+        static constexpr size_t count = 2;
+        static constexpr size_t size = (POTS_SIZE + 1) / 2;
+        static constexpr word mask = (0xFFFFul >> SHIFT) * 0x00010001ul; //drops the bits shifted into the lower channel
+
+        template <class STORAGE>
+        static word pack(const STORAGE (&data)[POTS_SIZE], const size_t i)
+        {
+            return (i + 1 < POTS_SIZE) ? (static_cast<word>(data[i]) | (static_cast<word>(data[i + 1]) << 16)) : static_cast<word>(data[i]);
+        }
+
+        template <class STORAGE>
+        static void unpack(STORAGE (&data)[POTS_SIZE], const size_t i, const word value)
+        {
+            data[i] = value & 0xFFFF;
+
+            if (i + 1 < POTS_SIZE)
+                data[i + 1] = value >> 16;
+        }
+    };
+
+    //Calls stage.update<AXIS>(data[i], i) with the AXIS of every potentiometer, or with the only AXIS given for all of them
+    template <class... AXES>
+    struct per_axis;
+
+    template <>
+    struct per_axis<>
+    {
+        template <size_t I, class STAGE, class STORAGE, size_t POTS_SIZE>
+        static void each(STAGE&, STORAGE (&)[POTS_SIZE]) {}
+    };
+
+    template <class AXIS, class... REST>
+    struct per_axis<AXIS, REST...>
+    {
+        template <size_t I, class STAGE, class STORAGE, size_t POTS_SIZE>
+        static void each(STAGE& stage, STORAGE (&data)[POTS_SIZE])
+        {
+            stage.template update<AXIS>(data[I], I);
+            per_axis<REST...>::template each<I + 1>(stage, data);
+        }
+
+        template <class STAGE, class STORAGE, size_t POTS_SIZE, size_t value_r = sizeof...(REST), typename detail::enable_if<(value_r == 0)>::type* = nullptr>
+        static void apply(STAGE& stage, STORAGE (&data)[POTS_SIZE])
+        {
+            for (size_t i = 0; i < POTS_SIZE; ++i)
+                stage.template update<AXIS>(data[i], i);
+        }
+
+        template <class STAGE, class STORAGE, size_t POTS_SIZE, size_t value_r = sizeof...(REST), typename detail::enable_if<(value_r != 0)>::type* = nullptr>
+        static void apply(STAGE& stage, STORAGE (&data)[POTS_SIZE])
+        {
+            static_assert(value_r + 1 == POTS_SIZE, "Give one set of parameters for every potentiometer, or a single one for all of them");
+            each<0>(stage, data);
+        }
+    };
+
+    template <size_t... I>
+    struct index_sequence
+    {
+        typedef index_sequence type;
+    };
+
+    template <size_t N, size_t... I>
+    struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+
+    template <size_t... I>
+    struct make_index_sequence<0, I...> : index_sequence<I...> {};
+
+    //Response curve of CURVE expanded into CURVE::segments + 1 points from 0 to MAX_VALUE, plus a copy of the last one to interpolate MAX_VALUE
+    template <class CURVE, uint_fast32_t MAX_VALUE, class = typename make_index_sequence<CURVE::segments + 2>::type>
+    struct curve_table;
+
+    template <class CURVE, uint_fast32_t MAX_VALUE, size_t... I>
+    struct curve_table<CURVE, MAX_VALUE, index_sequence<I...>>
+    {
+        static_assert(MAX_VALUE <= 0xFFFF, "Response curves support up to 16-bit values");
+        static_assert((CURVE::segments > 0) && (CURVE::segments <= 128), "Response curves support 1 to 128 segments");
+
+        //fraction bits of a position in the table, as many as fit in 31 bits when interpolating
+        static constexpr uint_fast8_t frac = 15 - bit_width(CURVE::segments - 1);
+
+        //position of MAX_VALUE in the table, rounded up so MAX_VALUE reaches the last point
+        static constexpr uint_fast32_t factor = ((static_cast<uint_fast32_t>(CURVE::segments) << (frac + 16)) / MAX_VALUE) + 1;
+
+        static constexpr unsigned long long point(const unsigned long long value)
+        {
+            return (((value < 0xFFFF ? value : 0xFFFF) * MAX_VALUE) + 0x7FFF) / 0xFFFF;
+        }
+
+        static constexpr unsigned long long at(const size_t i)
+        {
+            return point(CURVE::value(((i < CURVE::segments ? i : CURVE::segments) * 0xFFFFull) / CURVE::segments));
+        }
+
+        static const uint16_t values[sizeof...(I)];
+    };
+
+    template <class CURVE, uint_fast32_t MAX_VALUE, size_t... I>
+    const uint16_t curve_table<CURVE, MAX_VALUE, index_sequence<I...>>::values[sizeof...(I)] = { static_cast<uint16_t>(at(I))... };
+
+    //Stages of Joystick_filters, applied in order
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE, class... FILTERS>
+    struct filter_chain
+    {
+        void operator()(typename POLICY::storage_type (&)[POTS_SIZE]) {}
+    };
+
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE, class FILTER, class... REST>
+    struct filter_chain<POLICY, POTS_SIZE, MAX_VALUE, FILTER, REST...>
+    {
+        typename FILTER::template stage<POLICY, POTS_SIZE, MAX_VALUE> first;
+        filter_chain<POLICY, POTS_SIZE, MAX_VALUE, REST...> rest;
+
+        void operator()(typename POLICY::storage_type (&data)[POTS_SIZE])
+        {
+            first(data);
+            rest(data);
+        }
+    };
+
+    //Buttons the policy reads with the opposite polarity of IS_PULL_UP, packed like data_buttons
+    template <class POLICY, size_t BUTTONS_SIZE, class = typename make_index_sequence<round_to_word<typename POLICY::storage_type>(BUTTONS_SIZE)>::type>
+    struct inverted_buttons;
+
+    template <class POLICY, size_t BUTTONS_SIZE, size_t... I>
+    struct inverted_buttons<POLICY, BUTTONS_SIZE, index_sequence<I...>>
+    {
+        typedef typename POLICY::storage_type storage_type;
+
+        static constexpr size_t WORD_BITS = sizeof(storage_type) * CHAR_BIT;
+
+        static constexpr storage_type word(const size_t index, const size_t bit = 0)
+        {
+            return (bit < WORD_BITS) ? static_cast<storage_type>(((((index * WORD_BITS) + bit) < BUTTONS_SIZE) && POLICY::inverted((index * WORD_BITS) + bit) ? (static_cast<storage_type>(1) << bit) : 0) | word(index, bit + 1)) : 0;
+        }
+
+        static constexpr bool any(const size_t index = 0)
+        {
+            return (index < sizeof...(I)) && (word(index) || any(index + 1));
+        }
+
+        static constexpr storage_type words[sizeof...(I)] = { word(I)... };
+    };
+
+    template <class POLICY, size_t BUTTONS_SIZE, size_t... I>
+    constexpr typename POLICY::storage_type inverted_buttons<POLICY, BUTTONS_SIZE, index_sequence<I...>>::words[sizeof...(I)];
+
+    //POV value of a hat: 0 is up and every step turns 45 degrees clockwise up to 7, 8 is centered
+    constexpr uint8_t hat_value(const int vertical, const int horizontal)
+    {
+        return (vertical > 0) ? ((horizontal > 0) ? 1 : (horizontal < 0) ? 7 : 0)
+             : (vertical < 0) ? ((horizontal > 0) ? 3 : (horizontal < 0) ? 5 : 4)
+             : ((horizontal > 0) ? 2 : (horizontal < 0) ? 6 : 8);
+    }
+
+    //Pressed directions are UP | RIGHT << 1 | DOWN << 2 | LEFT << 3, opposite directions cancel out
+    constexpr uint8_t hat_value(const size_t directions)
+    {
+        return hat_value(static_cast<int>(directions & 1) - static_cast<int>((directions >> 2) & 1), static_cast<int>((directions >> 1) & 1) - static_cast<int>((directions >> 3) & 1));
+    }
+
+    template <class = typename make_index_sequence<16>::type>
+    struct hat_table;
+
+    template <size_t... I>
+    struct hat_table<index_sequence<I...>>
+    {
+        static const uint8_t values[sizeof...(I)];
+    };
+
+    template <size_t... I>
+    const uint8_t hat_table<index_sequence<I...>>::values[sizeof...(I)] = { hat_value(I)... };
+
+    //pinMode of a button pulled up or down, INPUT when the board has no such pull
+    constexpr uint8_t pull_mode(const bool pull_up)
+    {
+    #if defined(INPUT_PULLUP) && defined(INPUT_PULLDOWN)
+        return pull_up ? INPUT_PULLUP : INPUT_PULLDOWN;
+    #elif defined(INPUT_PULLUP)
+        #warning INPUT_PULLDOWN is not defined, falling back to INPUT
+        return pull_up ? INPUT_PULLUP : INPUT;
+    #else
+        #warning INPUT_PULLUP is not defined, falling back to INPUT
+        return INPUT;
+    #endif
+    }
+
+#if defined(portInputRegister) && defined(digitalPinToPort) && defined(digitalPinToBitMask)
+    //Input register and mask of a pin, resolved once so reading it skips the lookups of digitalRead
+    struct fast_pin
+    {
+        decltype(portInputRegister(digitalPinToPort(0))) input = nullptr;
+        decltype(digitalPinToBitMask(0)) mask = 0;
+
+        void attach(const uint_fast8_t pin)
+        {
+            input = portInputRegister(digitalPinToPort(pin));
+            mask = digitalPinToBitMask(pin);
+        }
+
+        bool read() const { return *input & mask; }
+    };
+#else
+    struct fast_pin
+    {
+        uint_fast8_t pin = 0;
+
+        void attach(const uint_fast8_t pin) { this->pin = pin; }
+        bool read() const { return digitalRead(pin); }
+    };
+#endif
+
+#if defined(portInputRegister) && defined(digitalPinToPort) && defined(digitalPinToBitMask)
+    //Pins of BUTTONS resolved once by setup into their input registers and masks, sorted by port.
+    //Reading them takes one volatile read of every port instead of the table lookups of digitalRead for every pin.
+    template <size_t BUTTONS_SIZE>
+    struct pin_cache
+    {
+        typedef decltype(portInputRegister(digitalPinToPort(0))) input_type;
+        typedef decltype(digitalPinToBitMask(0)) mask_type;
+
+        input_type inputs[BUTTONS_SIZE]; //input register of every port, of every pin until sort
+        mask_type masks[BUTTONS_SIZE];
+        uint_least16_t buttons[BUTTONS_SIZE];
+        uint_least16_t ends[BUTTONS_SIZE]; //one past the last pin of every port
+        size_t ports = 0;
+
+        void attach(const size_t button, const uint_fast8_t pin)
+        {
+            inputs[button] = portInputRegister(digitalPinToPort(pin));
+            masks[button] = digitalPinToBitMask(pin);
+            buttons[button] = button;
+        }
+
+        //Insertion sort by register, every run of the same register then becoming one port
+        void sort()
+        {
+            for (size_t i = 1; i < BUTTONS_SIZE; ++i)
+            {
+                const input_type input = inputs[i];
+                const mask_type mask = masks[i];
+                const uint_least16_t button = buttons[i];
+                size_t z = i;
+
+                for (; (z > 0) && (reinterpret_cast<uintptr_t>(inputs[z - 1]) > reinterpret_cast<uintptr_t>(input)); --z)
+                {
+                    inputs[z] = inputs[z - 1];
+                    masks[z] = masks[z - 1];
+                    buttons[z] = buttons[z - 1];
+                }
+
+                inputs[z] = input;
+                masks[z] = mask;
+                buttons[z] = button;
+            }
+
+            ports = 0;
+
+            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
+            {
+                if ((ports == 0) || (inputs[ports - 1] != inputs[i]))
+                    inputs[ports++] = inputs[i];
+
+                ends[ports - 1] = i + 1;
+            }
+        }
+
+        template <bool IS_PULL_UP, class WORD, size_t WORDS>
+        void read(WORD (&data)[WORDS]) const
+        {
+            for (size_t port = 0, i = 0; port < ports; ++port)
+            {
+                const auto levels = *inputs[port];
+
+                for (; i < ends[port]; ++i)
+                {
+                    if (static_cast<bool>(levels & masks[i]) != IS_PULL_UP)
+                        data[buttons[i] / (sizeof(WORD) * CHAR_BIT)] |= (static_cast<WORD>(1) << (buttons[i] % (sizeof(WORD) * CHAR_BIT)));
+                }
+            }
+        }
+    };
+#else
+    //Pins of BUTTONS copied to RAM by setup, boards without input registers still reading them with digitalRead
+    template <size_t BUTTONS_SIZE>
+    struct pin_cache
+    {
+        uint8_t pins[BUTTONS_SIZE];
+
+        void attach(const size_t button, const uint_fast8_t pin) { pins[button] = pin; }
+        void sort() {}
+
+        template <bool IS_PULL_UP, class WORD, size_t WORDS>
+        void read(WORD (&data)[WORDS]) const
+        {
+            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
+                data[i / (sizeof(WORD) * CHAR_BIT)] |= (static_cast<WORD>((digitalRead(pins[i]) == LOW) == IS_PULL_UP) << (i % (sizeof(WORD) * CHAR_BIT)));
+        }
+    };
+#endif
+
+    template <>
+    struct pin_cache<0>
+    {
+        void attach(const size_t, const uint_fast8_t) {}
+        void sort() {}
+
+        template <bool IS_PULL_UP, class WORD, size_t WORDS>
+        void read(WORD (&)[WORDS]) const {}
+    };
+
+    //Potentiometers sent as channels, the ones only sent as thresholds being left out
+    template <class THRESHOLDS>
+    constexpr size_t sent_pots(const size_t pots)
+    {
+        return (pots > 0) ? (sent_pots<THRESHOLDS>(pots - 1) + (THRESHOLDS::sends(pots - 1) ? 1 : 0)) : 0;
+    }
+
+    template <class T, size_t BUTTONS_SIZE, size_t POTS_SIZE, bool IS_PULL_UP, class POLICY>
+    class base_Joystick_BUTTONS
+    {
+    protected:
+        typedef typename POLICY::storage_type storage_type;
+        typedef typename POLICY::compute_type compute_type;
+
+    protected:
+        base_Joystick_BUTTONS() {}
+        storage_type data_buttons[detail::round_to_word<storage_type>(BUTTONS_SIZE + POLICY::thresholds::size)] = {0}; //thresholds follow the buttons
+        typename POLICY::button_source buttons;
+
+        static constexpr bool CACHED = detail::is_same<typename POLICY::button_source, Joystick_cached_pins>::value;
+        static constexpr bool PINS = detail::is_same<typename POLICY::button_source, Joystick_button_pins>::value || CACHED; //BUTTONS are pins
+        detail::pin_cache<CACHED ? BUTTONS_SIZE : 0> cache;
+        static constexpr size_t WORD_BITS = sizeof(storage_type) * CHAR_BIT;
+
+        typedef detail::inverted_buttons<POLICY, BUTTONS_SIZE> INVERTED;
+
+        //Buttons of the opposite polarity are flipped by one XOR per word, skipped when there are none, then hats are encoded
+        void read_buttons()
+        {
+            read_levels();
+
+            if (INVERTED::any())
+            {
+                for (size_t i = 0; i < detail::round_to_word<storage_type>(BUTTONS_SIZE); ++i)
+                    data_buttons[i] ^= INVERTED::words[i];
+            }
+
+            POLICY::hats::template encode<BUTTONS_SIZE>(data_buttons);
+        }
+
+        template<bool pins = PINS, bool cached = CACHED, typename detail::enable_if<pins && !cached>::type* = nullptr>
+        void read_levels()
+        {
+            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
+                data_buttons[i / WORD_BITS] |= (static_cast<storage_type>((digitalRead(JOYSTICK->BUTTONS[i]) == LOW) == IS_PULL_UP) << (i % WORD_BITS));
+        }
+
+        template<bool cached = CACHED, typename detail::enable_if<cached>::type* = nullptr>
+        void read_levels()
+        {
+            cache.template read<IS_PULL_UP>(data_buttons);
+        }
+
+        template<bool pins = PINS, typename detail::enable_if<!pins>::type* = nullptr>
+        void read_levels()
+        {
+            buttons.template read<BUTTONS_SIZE, IS_PULL_UP>(data_buttons);
+        }
+
+        template<bool pins = PINS, typename detail::enable_if<pins>::type* = nullptr>
+        void setup_buttons()
+        {
+            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
+            {
+                pinMode(JOYSTICK->BUTTONS[i], detail::pull_mode(IS_PULL_UP != POLICY::inverted(i)));
+                cache.attach(i, JOYSTICK->BUTTONS[i]);
+            }
+
+            cache.sort();
+        }
+
+        template<bool pins = PINS, typename detail::enable_if<!pins>::type* = nullptr>
+        void setup_buttons()
+        {
+            buttons.template setup<IS_PULL_UP, POLICY, 0>();
+        }
+
+        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b >= value_p)>::type* = nullptr>
+        void print_buttons()
+        {
+            JOYSTICK->printComma = &T::printComma_;
+
+            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+                
+                POLICY::console().print(JOYSTICK->BUTTONS[i]);
+                POLICY::console().print(":");
+                POLICY::console().print(bitRead(data_buttons[i / (sizeof(storage_type) * CHAR_BIT)], i % (sizeof(storage_type) * CHAR_BIT)));
+            }
+
+            POLICY::console().println();
+        }
+
+        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_p > value_b)>::type* = nullptr>
+        void print_buttons()
+        {
+            JOYSTICK->printComma = &T::printComma_;
+
+            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+                
+                POLICY::console().print(JOYSTICK->BUTTONS[i]);
+                POLICY::console().print(":");
+                POLICY::console().print(bitRead(data_buttons[i / (sizeof(storage_type) * CHAR_BIT)], i % (sizeof(storage_type) * CHAR_BIT)));
+            }
+
+            for (size_t i = 0; i < POTS_SIZE - BUTTONS_SIZE; ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+                POLICY::console().print("N/A:0");
+            }
+            
+            POLICY::console().println();
+        }
+    };
+
+    //Without buttons, data_buttons only holds the thresholds
+    template <class WORD, size_t THRESHOLDS_SIZE>
+    struct threshold_buttons
+    {
+        WORD data_buttons[round_to_word<WORD>(THRESHOLDS_SIZE)] = {0};
+    };
+
+    template <class WORD>
+    struct threshold_buttons<WORD, 0> {};
+
+    template <class T, size_t POTS_SIZE, bool IS_PULL_UP, class POLICY>
+    class base_Joystick_BUTTONS<T, 0, POTS_SIZE, IS_PULL_UP, POLICY> : protected threshold_buttons<typename POLICY::storage_type, POLICY::thresholds::size> {};
+
+    //Calibration values precomputed into a fixed-point factor, so scaling a potentiometer needs no division
+    template <class POLICY>
+    struct pot_scale
+    {
+        typedef typename POLICY::storage_type storage_type;
+        typedef typename POLICY::compute_type compute_type;
+
+        storage_type min = 0;
+        storage_type range = 0;
+        uint_fast32_t factor = 0;
+        bool inverted = false; //MIN greater than MAX reverses the axis
+
+        void set(const storage_type MIN, const storage_type MAX)
+        {
+            inverted = MIN > MAX;
+            min = inverted ? MAX : MIN;
+            range = inverted ? (MIN - MAX) : (MAX - MIN);
+            factor = range ? ((((uint_fast32_t)pot_max<POLICY>() << 16) / range) + 1) : 0; //rounded up so MAX reaches pot_max
+        }
+
+        compute_type operator()(compute_type value) const //values outside of the calibration are clamped
+        {
+            value = (value > min) ? (value - min) : 0;
+            value = (value > range) ? range : value;
+            value = ((uint_fast32_t)value * factor) >> 16;
+
+            return inverted ? (pot_max<POLICY>() - value) : value;
+        }
+    };
+
+    template <class T, size_t BUTTONS_SIZE, size_t POTS_SIZE, size_t PROFILES, class POLICY>
+    class base_Joystick_POTS
+    {
+    protected:
+        typedef typename POLICY::storage_type storage_type;
+        typedef typename POLICY::compute_type compute_type;
+
+        static_assert(POLICY::pot_bits <= 16, "pot_bits must be 16 or less, the size of a vJoySerialFeeder channel");
+
+    private:
+        void calibrate(const size_t profile)
+        {
+            storage_type* const CALIBRATION = JOYSTICK->CALIBRATION + (profile * POTS_SIZE * 2);
+
+            for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
+            {
+                CALIBRATION[i] = -1; //min - standard enforces 2s complement for unsinged variables
+                CALIBRATION[++i] = 0; //max
+            }
+
+            if (PROFILES > 1)
+            {
+                POLICY::console().print("Calibrating profile ");
+                POLICY::console().println(profile);
+            }
+
+            POLICY::console().println("Adjust the potentiometers to reach their maximum and minimum values.");
+            POLICY::console().println("Once finished input any character into the Serial Monitor.");
+            POLICY::console().println();
+
+            while (POLICY::console().available())
+                POLICY::console().read();
+
+            while (!POLICY::console().available())
+            {
+                for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
+                {
+                    compute_type value = read_pot(JOYSTICK->POTS[i/2]);
+
+                    if (value < CALIBRATION[i])
+                    {
+                        CALIBRATION[i] = value;
+                        ++i;
+                        continue;
+                    }
+
+                    if (value > CALIBRATION[++i])
+                    {
+                        CALIBRATION[i] = value;
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
+            {
+                if (CALIBRATION[i] == CALIBRATION[i + 1])
+                {
+                    POLICY::console().print("Potentiometer PIN_");
+                    POLICY::console().print(JOYSTICK->POTS[i/2]);
+                    POLICY::console().println(" has same MIN and MAX.");
+                    POLICY::console().println("Defaulting to min and max values");
+                    POLICY::console().println();
+
+                    CALIBRATION[i] = 0;
+                    CALIBRATION[++i] = -1; //standard enforces 2s complement for unsinged variables
+                    continue;
+                }
+
+                ++i;
+            }
+
+            POLICY::console().print("Calibration complete, the values are: ");
+
+            JOYSTICK->printComma = &T::printComma_;
+
+            for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+                POLICY::console().print(CALIBRATION[i]);
+            }
+
+            POLICY::console().println();
+            POLICY::console().println();
+
+            POLICY::console().println("Use these values for the CALIBRATION variable to prevent this procedure.");
+            POLICY::console().println();
+        }
+
+    protected:
+        base_Joystick_POTS() {}
+        storage_type data_pots[POTS_SIZE] = {0};
+        typename POLICY::filter::template stage<POLICY, POTS_SIZE, pot_max<POLICY>()> filter;
+        typename POLICY::pot_schedule::template schedule<POLICY, POTS_SIZE> schedule;
+        typename POLICY::pot_source source;
+
+        static constexpr uint_fast16_t SAMPLES = static_cast<uint_fast16_t>(1) << (2 * POLICY::oversample_bits); //conversions of every potentiometer
+        static constexpr bool ASYNCHRONOUS = detail::source_asynchronous<typename POLICY::pot_source>(0);
+
+        bool due[POTS_SIZE];
+        size_t first = POTS_SIZE; //first potentiometer due, started by start_pots
+
+        pot_scale<POLICY> scale[PROFILES][POTS_SIZE];
+        const pot_scale<POLICY>* profile = scale[0];
+
+        //Sums SAMPLES conversions, keeping oversample_bits more bits than a single one
+        compute_type read_pot(const uint_fast8_t pin)
+        {
+            uint_fast32_t sum = 0;
+
+            for (uint_fast16_t i = 0; i < SAMPLES; ++i)
+            {
+                source.start(pin);
+                sum += source.collect();
+            }
+
+            return sum >> POLICY::oversample_bits;
+        }
+
+        //Starts converting the first potentiometer due with an asynchronous pot_source, so the conversion runs while the buttons are read
+        void start_pots()
+        {
+            static_assert(POLICY::oversample_bits <= 6, "oversample_bits must be 6 or less");
+            static_assert(POLICY::adc_bits + POLICY::oversample_bits <= sizeof(compute_type) * CHAR_BIT, "adc_bits + oversample_bits must fit in compute_type");
+            static_assert(detail::source_adc_bits<typename POLICY::pot_source>(0) == 0 || detail::source_adc_bits<typename POLICY::pot_source>(0) == POLICY::adc_bits, "adc_bits must be the resolution of the pot_source");
+            static_assert(POLICY::adc_bits + POLICY::oversample_bits <= sizeof(storage_type) * CHAR_BIT, "adc_bits + oversample_bits must fit in storage_type, which holds the raw reads of CALIBRATION");
+
+            schedule.start();
+            first = POTS_SIZE;
+
+            for (size_t i = POTS_SIZE; i-- > 0;)
+            {
+                due[i] = schedule.due(i);
+                first = due[i] ? i : first;
+            }
+
+            if (ASYNCHRONOUS && (first < POTS_SIZE))
+                source.start(JOYSTICK->POTS[first]);
+        }
+
+        //Conversions are pipelined: the next one is started before the last one is summed and scaled.
+        //SAMPLES conversions of every potentiometer due are summed, keeping oversample_bits more bits than a single one.
+        template<bool value_a = ASYNCHRONOUS, typename detail::enable_if<value_a>::type* = nullptr>
+        void read_pots()
+        {
+            uint_fast32_t sum = 0;
+            uint_fast16_t samples = 0;
+
+            for (size_t i = first; i < POTS_SIZE;)
+            {
+                const compute_type value = source.collect();
+                size_t next = i;
+
+                if (++samples == SAMPLES)
+                {
+                    samples = 0;
+                    while ((++next < POTS_SIZE) && !due[next]) {}
+                }
+
+                if (next < POTS_SIZE)
+                    source.start(JOYSTICK->POTS[next]);
+
+                sum += value;
+
+                if (next != i)
+                {
+                    data_pots[i] = schedule.hold(i, profile[i](sum >> POLICY::oversample_bits));
+                    sum = 0;
+                }
+
+                i = next;
+            }
+
+            for (size_t i = 0; i < POTS_SIZE; ++i)
+            {
+                if (!due[i])
+                    data_pots[i] = schedule.held(i);
+            }
+
+            filter(data_pots);
+        }
+
+        //A source converting within collect gains nothing from the pipeline, so every conversion is started and collected in turn
+        template<bool value_a = ASYNCHRONOUS, typename detail::enable_if<!value_a>::type* = nullptr>
+        void read_pots()
+        {
+            for (size_t i = 0; i < POTS_SIZE; ++i)
+            {
+                if (!due[i])
+                {
+                    data_pots[i] = schedule.held(i);
+                    continue;
+                }
+
+                data_pots[i] = schedule.hold(i, profile[i](read_pot(JOYSTICK->POTS[i])));
+            }
+
+            filter(data_pots);
+        }
+
+        void select_pots_profile(const size_t index)
+        {
+            if (index < PROFILES)
+                profile = scale[index];
+        }
+
+        void load_profiles()
+        {
+            for (size_t i = 0, count = 0; i < (POTS_SIZE * PROFILES); ++i, count += 2)
+                scale[i / POTS_SIZE][i % POTS_SIZE].set(JOYSTICK->CALIBRATION[count], JOYSTICK->CALIBRATION[count + 1]);
+        }
+
+        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_p >= value_b)>::type* = nullptr>
+        void print_pots()
+        {
+            JOYSTICK->printComma = &T::printComma_;
+
+            for (size_t i = 0; i < POTS_SIZE; ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+
+                POLICY::console().print(JOYSTICK->POTS[i]);
+                POLICY::console().print(":");
+                POLICY::console().print(data_pots[i]);
+            }
+            
+            POLICY::console().println();
+        }
+
+        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b > value_p)>::type* = nullptr>
+        void print_pots()
+        {
+            JOYSTICK->printComma = &T::printComma_;
+
+            for (size_t i = 0; i < POTS_SIZE; ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+
+                POLICY::console().print(JOYSTICK->POTS[i]);
+                POLICY::console().print(":");
+                POLICY::console().print(data_pots[i]);
+            }
+
+            for (size_t i = 0; i < BUTTONS_SIZE - POTS_SIZE; ++i)
+            {
+                (JOYSTICK->*(JOYSTICK->printComma))();
+                POLICY::console().print("N/A:0");
+            }
+
+            POLICY::console().println();
+        }
+
+        void setup_adc()
+        {
+        #if defined(ESP32) || defined(ARDUINO_ARCH_SAMD) || defined(ARDUINO_ARCH_SAM) || defined(ARDUINO_ARCH_RP2040) || defined(ARDUINO_ARCH_RENESAS) || defined(TEENSYDUINO)
+            if (POLICY::set_adc_bits)
+                analogReadResolution(POLICY::adc_bits);
+        #endif
+        }
+
+        void setup_pots()
+        {
+            setup_adc();
+
+            for (const auto itr : JOYSTICK->POTS)
+                source.setup(itr);
+
+            for (size_t profile = 0; profile < PROFILES; ++profile)
+            {
+                const storage_type* const CALIBRATION = JOYSTICK->CALIBRATION + (profile * POTS_SIZE * 2);
+                size_t i = 0;
+
+                while (i < (POTS_SIZE * 2) && CALIBRATION[i] == 0)
+                    ++i;
+
+                if (i == (POTS_SIZE * 2))
+                    calibrate(profile);
+            }
+
+            load_profiles();
+        }
+    };
+
+    template <class T, size_t BUTTONS_SIZE, size_t PROFILES, class POLICY>
+    class base_Joystick_POTS<T, BUTTONS_SIZE, 0, PROFILES, POLICY> {};
+
+    //Samples waiting to be sent in one frame, nothing when every frame carries a single sample
+    template <size_t SIZE, uint_fast8_t SAMPLES>
+    struct frame_batch
+    {
+        uint8_t frame[SIZE];
+        uint_fast8_t count = 0;
+        unsigned long last = 0;
+    };
+
+    template <size_t SIZE>
+    struct frame_batch<SIZE, 1> {};
+
+    template <class T, size_t ENCODERS_SIZE, class POLICY>
+    class base_Joystick_ENCODERS
+    {
+    protected:
+        typedef typename POLICY::storage_type storage_type;
+
+    protected:
+        base_Joystick_ENCODERS() {}
+        storage_type data_encoders[ENCODERS_SIZE] = {0};
+        typename POLICY::encoders encoders;
+
+        void setup_encoders()
+        {
+            encoders.setup();
+        }
+
+        void read_encoders()
+        {
+            encoders.read(data_encoders);
+        }
+
+        //Tells the encoders whether the frame holding their staged channels was written
+        void settle_encoders(const bool written)
+        {
+            encoders.settle(written);
+        }
+    };
+
+    template <class T, class POLICY>
+    class base_Joystick_ENCODERS<T, 0, POLICY>
+    {
+    protected:
+        void setup_encoders() {}
+        void read_encoders() {}
+        void settle_encoders(const bool) {}
+    };
+
+    template <class T, size_t BUTTONS_SIZE, size_t POTS_SIZE, bool IS_PULL_UP, size_t PROFILES, class POLICY>
+    class base_Joystick : protected base_Joystick_BUTTONS<T, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, POLICY>, protected base_Joystick_POTS<T, BUTTONS_SIZE, POTS_SIZE, PROFILES, POLICY>, protected base_Joystick_ENCODERS<T, POLICY::encoders::size, POLICY>
+    {
+    protected:
+        typedef typename POLICY::storage_type storage_type;
+        typedef typename POLICY::compute_type compute_type;
+
+    protected:
+        base_Joystick() {}
+
+        void (base_Joystick::*printComma)();
+        void printComma_() { printComma = &base_Joystick::printComma__; }
+        void printComma__() { POLICY::console().print(", "); }
+
+        void (base_Joystick::*print_)() = &base_Joystick::print__;
+
+        void print__()
+        { 
+            while (POLICY::console().available())
+                POLICY::console().read();
+
+            POLICY::console().println("Enter 0 to print buttons or 1 to print potentiometers.");
+            POLICY::console().println("You are able to switch between the two, just enter the value into Serial later.");
+            POLICY::console().println();
+
+            while (!POLICY::console().available()) {}
+            JOYSTICK->determine_print();
+        }
+
+        static constexpr size_t ENCODERS_SIZE = POLICY::encoders::size;
+        static constexpr size_t THRESHOLDS_SIZE = POLICY::thresholds::size;
+        static constexpr size_t SENT_POTS = detail::sent_pots<typename POLICY::thresholds>(POTS_SIZE);
+        static constexpr size_t DATA_SIZE = (detail::round_to_word<storage_type>(BUTTONS_SIZE + THRESHOLDS_SIZE) * sizeof(storage_type)) + ((SENT_POTS + ENCODERS_SIZE) * sizeof(storage_type));
+        static constexpr size_t FRAME_SIZE = 4 + DATA_SIZE;
+        static constexpr size_t BATCH_SIZE = 4 + (POLICY::batch_samples * (2 + DATA_SIZE));
+
+        static_assert(FRAME_SIZE <= 0xFF, "Too many inputs for the length byte of an IBUS frame");
+        static_assert(POTS_SIZE > 0 || THRESHOLDS_SIZE == 0, "Thresholds need potentiometers");
+        static_assert(POLICY::batch_samples > 0, "batch_samples must be at least 1");
+        static_assert(POLICY::batch_samples == 1 || BATCH_SIZE <= 0xFF, "Too many batch_samples for the length byte of a frame");
+
+        uint_fast32_t drops = 0; //frames skipped by send_data
+        int room = 0; //most room the port reported for write_frame
+        detail::frame_batch<BATCH_SIZE, POLICY::batch_samples> batch;
+        typename POLICY::thresholds thresholds;
+
+        //Sets or clears the bit of every threshold from the filtered potentiometers
+        template<size_t value_t = THRESHOLDS_SIZE, typename detail::enable_if<(value_t > 0)>::type* = nullptr>
+        void read_thresholds()
+        {
+            thresholds.read(this->data_pots, this->data_buttons, BUTTONS_SIZE);
+        }
+
+        template<size_t value_t = THRESHOLDS_SIZE, typename detail::enable_if<(value_t == 0)>::type* = nullptr>
+        void read_thresholds() {}
+
+        //Stores words in little endian
+        template <size_t SIZE>
+        static uint8_t* put_words(uint8_t* itr, const storage_type (&words)[SIZE])
+        {
+            for (const auto word : words)
+            {
+                for (size_t z = 0; z < sizeof(storage_type); ++z)
+                    *itr++ = (uint8_t)(word >> (z * CHAR_BIT));
+            }
+
+            return itr;
+        }
+
+        template<size_t value_b = BUTTONS_SIZE + THRESHOLDS_SIZE, typename detail::enable_if<(value_b > 0)>::type* = nullptr>
+        uint8_t* put_buttons(uint8_t* itr)
+        {
+            return put_words(itr, this->data_buttons);
+        }
+
+        template<size_t value_b = BUTTONS_SIZE + THRESHOLDS_SIZE, typename detail::enable_if<(value_b == 0)>::type* = nullptr>
+        uint8_t* put_buttons(uint8_t* itr)
+        {
+            return itr;
+        }
+
+        template<size_t value_p = SENT_POTS, typename detail::enable_if<(value_p > 0 && value_p == POTS_SIZE)>::type* = nullptr>
+        uint8_t* put_pots(uint8_t* itr)
+        {
+            return put_words(itr, this->data_pots);
+        }
+
+        //Potentiometers only sent as thresholds are skipped
+        template<size_t value_p = SENT_POTS, typename detail::enable_if<(value_p > 0 && value_p < POTS_SIZE)>::type* = nullptr>
+        uint8_t* put_pots(uint8_t* itr)
+        {
+            for (size_t i = 0; i < POTS_SIZE; ++i)
+            {
+                if (!POLICY::thresholds::sends(i))
+                    continue;
+
+                for (size_t z = 0; z < sizeof(storage_type); ++z)
+                    *itr++ = (uint8_t)(this->data_pots[i] >> (z * CHAR_BIT));
+            }
+
+            return itr;
+        }
+
+        template<size_t value_p = SENT_POTS, typename detail::enable_if<(value_p == 0)>::type* = nullptr>
+        uint8_t* put_pots(uint8_t* itr)
+        {
+            return itr;
+        }
+
+        uint8_t* put_data(uint8_t* itr)
+        {
+            return put_pots(put_buttons(itr));
+        }
+
+        template<size_t value_e = ENCODERS_SIZE, typename detail::enable_if<(value_e > 0)>::type* = nullptr>
+        uint8_t* put_encoders(uint8_t* itr)
+        {
+            this->encoders.stage(this->data_encoders);
+            return put_words(itr, this->data_encoders);
+        }
+
+        template<size_t value_e = ENCODERS_SIZE, typename detail::enable_if<(value_e == 0)>::type* = nullptr>
+        uint8_t* put_encoders(uint8_t* itr)
+        {
+            return itr;
+        }
+
+        //The whole frame is assembled first and only written if the port can take all of it without blocking.
+        //Otherwise it is dropped, so the next send carries the newest values instead of queueing behind old ones.
+        //A frame longer than the most room the port ever reported could never be sent, so it is written blocking instead.
+        //Returns whether the frame was written.
+        template <size_t SIZE>
+        bool write_frame(uint8_t (&frame)[SIZE])
+        {
+            uint16_t checksum = 0xffff;
+
+            for (size_t i = 0; i < (SIZE - 2); ++i)
+                checksum -= frame[i];
+
+            frame[SIZE - 2] = (uint8_t)checksum;
+            frame[SIZE - 1] = (uint8_t)(checksum >> CHAR_BIT);
+
+            if (!POLICY::blocking_send)
+            {
+                const int available = POLICY::port().availableForWrite();
+                room = (available > room) ? available : room;
+
+                if ((available < static_cast<int>(SIZE)) && (room >= static_cast<int>(SIZE)))
+                {
+                    ++drops;
+                    return false;
+                }
+            }
+
+            POLICY::port().write(frame, SIZE);
+            return true;
+        }
+
+        template<size_t value_s = POLICY::batch_samples, typename detail::enable_if<(value_s == 1)>::type* = nullptr>
+        void send_data()
+        {
+            uint8_t frame[FRAME_SIZE];
+            frame[0] = FRAME_SIZE;
+            frame[1] = 0x40;
+
+            put_encoders(put_data(frame + 2));
+            this->settle_encoders(write_frame(frame));
+        }
+
+        //Every call stores a sample with the microseconds elapsed since the previous one; the frame is sent once it holds batch_samples of them
+        template<size_t value_s = POLICY::batch_samples, typename detail::enable_if<(value_s > 1)>::type* = nullptr>
+        void send_data()
+        {
+            const unsigned long now = micros();
+            const unsigned long delta = (now - batch.last < 0xFFFF) ? (now - batch.last) : 0xFFFF;
+            uint8_t* const itr = batch.frame + 2 + (batch.count * (2 + DATA_SIZE));
+
+            batch.last = now;
+            itr[0] = (uint8_t)delta;
+            itr[1] = (uint8_t)(delta >> CHAR_BIT);
+            put_encoders(put_data(itr + 2));
+
+            if (++batch.count < POLICY::batch_samples)
+                return;
+
+            batch.count = 0;
+            batch.frame[0] = BATCH_SIZE;
+            batch.frame[1] = 0x41;
+            this->settle_encoders(write_frame(batch.frame));
+        }
+    };
+}
+
+#undef JOYSTICK
+
+//Converts the potentiometers with analogRead, which starts and waits for every conversion in collect
+struct Joystick_analog_read
+{
+    uint_fast8_t pin = 0;
+
+    void setup(const uint_fast8_t pin) { pinMode(pin, INPUT); }
+    void start(const uint_fast8_t pin) { this->pin = pin; }
+    uint_fast16_t collect() { return analogRead(pin); }
+};
+
+#if defined(__AVR__) && defined(ADCSRA) && defined(ADMUX)
+//Converts the potentiometers through the ADC registers of AVR boards. The next conversion then runs
+//while the last one is summed, scaled and stored. REFERENCE is the same as for analogReference.
+template <uint8_t REFERENCE = DEFAULT>
+struct Joystick_avr_adc
+{
+    static constexpr bool asynchronous = true;
+
+    void setup(const uint_fast8_t pin) { pinMode(pin, INPUT); }
+
+    void start(uint_fast8_t pin)
+    {
+    //pins to channels, as analogRead does
+    #if defined(analogPinToChannel)
+    #if defined(__AVR_ATmega32U4__)
+        if (pin >= 18)
+            pin -= 18;
+    #endif
+        pin = analogPinToChannel(pin);
+    #elif defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+        if (pin >= 54)
+            pin -= 54;
+    #else
+        if (pin >= 14)
+            pin -= 14;
+    #endif
+
+    #if defined(ADCSRB) && defined(MUX5)
+        ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((pin >> 3) & 0x01) << MUX5);
+    #endif
+
+        ADMUX = (REFERENCE << 6) | (pin & 0x07);
+        ADCSRA |= (1 << ADSC);
+    }
+
+    uint_fast16_t collect()
+    {
+        while (ADCSRA & (1 << ADSC)) {}
+
+        return ADC;
+    }
+};
+#endif
+
+#ifdef JOYSTICK_WIRE
+//Converts the channels of an ADS1115 at ADDRESS, POTS then holding its inputs AIN0 to AIN3, each read against GND. start writes a single shot
+//conversion and returns, so the conversion runs while the buttons are read and the last potentiometer is scaled; collect waits for it.
+//Results are 15 bits, so adc_bits must be 15. GAIN and RATE are the PGA and DR fields of the config register, defaulting to +-4.096V and 860SPS.
+//A chip that does not acknowledge, or whose conversion takes twice as long as RATE allows, reads 0 instead of blocking setup or read.
+template <uint8_t ADDRESS = 0x48, uint8_t GAIN = 0b001, uint8_t RATE = 0b111, uint32_t CLOCK = 400000>
+struct Joystick_ads1115
+{
+    static constexpr uint_fast8_t adc_bits = 15;
+    static constexpr bool asynchronous = true;
+
+    //Twice the conversion time of RATE, in microseconds: 8, 16, 32, 64, 128, 250, 475 or 860SPS
+    static constexpr unsigned long TIMEOUT = 2000000UL / ((RATE == 0) ? 8 : (RATE == 1) ? 16 : (RATE == 2) ? 32 : (RATE == 3) ? 64 : (RATE == 4) ? 128 : (RATE == 5) ? 250 : (RATE == 6) ? 475 : 860);
+
+    bool begun = false;
+    bool started = false;
+
+    void setup(uint_fast8_t)
+    {
+        if (begun)
+            return;
+
+        Wire.begin();
+        Wire.setClock(CLOCK);
+        begun = true;
+    }
+
+    void start(const uint_fast8_t channel)
+    {
+        //OS starts the conversion, MUX selects AINx against GND, single shot mode and comparator disabled
+        const uint16_t config = (1 << 15) | ((0b100 | (channel & 0b11)) << 12) | (GAIN << 9) | (1 << 8) | (RATE << 5) | 0b11;
+
+        Wire.beginTransmission(ADDRESS);
+        Wire.write(0x01);
+        Wire.write((uint8_t)(config >> 8));
+        Wire.write((uint8_t)config);
+        started = (Wire.endTransmission() == 0);
+    }
+
+    uint_fast16_t collect()
+    {
+        if (!started)
+            return 0;
+
+        const unsigned long begin = micros();
+        uint16_t value;
+
+        //OS reads 1 once the conversion is done
+        do
+        {
+            if (!read_register(0x01, value) || ((micros() - begin) > TIMEOUT))
+                return 0;
+        } while (!(value & (1 << 15)));
+
+        if (!read_register(0x00, value))
+            return 0;
+
+        return (static_cast<int16_t>(value) > 0) ? value : 0;
+    }
+
+    //Returns false when the chip does not acknowledge
+    static bool read_register(const uint8_t address, uint16_t& value)
+    {
+        Wire.beginTransmission(ADDRESS);
+        Wire.write(address);
+
+        if ((Wire.endTransmission() != 0) || (Wire.requestFrom(ADDRESS, (uint8_t)2) != 2))
+            return false;
+
+        const uint16_t high = Wire.read();
+        value = (high << 8) | (uint8_t)Wire.read();
+        return true;
+    }
+};
+#endif
+
+#ifdef JOYSTICK_SPI
+//Converts the channels of an MCP3208 (or MCP3204) selected by CS, POTS then holding its single ended channels. The whole conversion is clocked
+//by the 3 byte transfer of start, so collect returns at once. Results are 12 bits, so adc_bits must be 12. CLOCK is 1MHz at 2.7V, 2MHz at 5V.
+template <uint8_t CS, uint32_t CLOCK = 1000000>
+struct Joystick_mcp3208
+{
+    static constexpr uint_fast8_t adc_bits = 12;
+
+    uint_fast16_t value = 0;
+
+    void setup(uint_fast8_t)
+    {
+        pinMode(CS, OUTPUT);
+        digitalWrite(CS, HIGH);
+        SPI.begin();
+    }
+
+    void start(const uint_fast8_t channel)
+    {
+        SPI.beginTransaction(SPISettings(CLOCK, MSBFIRST, SPI_MODE0));
+        digitalWrite(CS, LOW);
+
+        //Start bit and single ended mode, then D2 D1 D0
+        SPI.transfer(0b110 | ((channel >> 2) & 1));
+        const uint_fast16_t high = SPI.transfer((channel & 0b11) << 6) & 0x0F;
+        value = (high << 8) | SPI.transfer(0);
+
+        digitalWrite(CS, HIGH);
+        SPI.endTransaction();
+    }
+
+    uint_fast16_t collect() { return value; }
+};
+#endif
+
+//Select code of the nth channel in Gray code order, in which consecutive channels differ by a single select line
+constexpr uint_fast8_t Joystick_gray(const uint_fast8_t n)
+{
+    return n ^ (n >> 1);
+}
+
+//Converts the channels of an analog multiplexer (CD4051, CD74HC4067...) wired to ADC_PIN through SOURCE, POTS then holding channels
+//instead of pins. Only the select lines of SELECT that differ from the last channel are written, so POTS listed in Gray code order
+//switch a single line per conversion. A switch defers the conversion to collect, which only starts it once SETTLE microseconds
+//have passed, so the settling runs while the buttons are read or the last potentiometer is scaled. DISCARD throws the first
+//conversion after a switch away, for the ADC to charge through the resistance of the multiplexer.
+template <uint8_t ADC_PIN, class SELECT, uint_fast16_t SETTLE = 0, bool DISCARD = false, class SOURCE = Joystick_analog_read>
+struct Joystick_mux
+{
+    static constexpr uint_fast8_t adc_bits = detail::source_adc_bits<SOURCE>(0);
+    static constexpr bool asynchronous = (SETTLE > 0) || detail::source_asynchronous<SOURCE>(0);
+
+    SOURCE source;
+    uint_fast8_t selected = 0;
+    bool settling = false; //conversion deferred to collect by a switch
+    unsigned long switched = 0; //micros of the last switch
+
+    void setup(uint_fast8_t)
+    {
+        source.setup(ADC_PIN);
+
+        for (size_t i = 0; i < SELECT::size; ++i)
+        {
+            pinMode(SELECT::pin(i), OUTPUT);
+            digitalWrite(SELECT::pin(i), (selected >> i) & 1);
+        }
+    }
+
+    void start(const uint_fast8_t channel)
+    {
+        const uint_fast8_t changed = channel ^ selected;
+
+        if (changed)
+        {
+            for (size_t i = 0; i < SELECT::size; ++i)
+            {
+                if ((changed >> i) & 1)
+                    digitalWrite(SELECT::pin(i), (channel >> i) & 1);
+            }
+
+            selected = channel;
+            switched = micros();
+            settling = true;
+            return;
+        }
+
+        source.start(ADC_PIN);
+    }
+
+    uint_fast16_t collect()
+    {
+        if (settling)
+        {
+            while ((micros() - switched) < SETTLE) {}
+
+            if (DISCARD)
+            {
+                source.start(ADC_PIN);
+                source.collect();
+            }
+
+            source.start(ADC_PIN);
+            settling = false;
+        }
+
+        return source.collect();
+    }
+};
+
+//Reads BUTTONS with digitalRead, done by the library itself
+struct Joystick_button_pins {};
+
+//Reads BUTTONS through their input registers, resolved by setup and grouped by port
+struct Joystick_cached_pins {};
+
+#ifdef JOYSTICK_SPI
+//Reads chained 74HC165 shift registers: a low pulse on LOAD (SH/LD) latches every input, then one hardware SPI burst
+//shifts them in. Button 0 is input A of the register wired to MISO, button 8 input A of the next one in the chain, etc.
+template <uint8_t LOAD, uint32_t CLOCK = 4000000>
+struct Joystick_74hc165
+{
+    template <bool IS_PULL_UP, class POLICY, size_t OFFSET>
+    void setup()
+    {
+        pinMode(LOAD, OUTPUT);
+        digitalWrite(LOAD, HIGH);
+        SPI.begin();
+    }
+
+    template <size_t BUTTONS_SIZE, bool IS_PULL_UP, class WORD, size_t WORDS>
+    void read(WORD (&data)[WORDS])
+    {
+        static constexpr size_t BYTES = (BUTTONS_SIZE + CHAR_BIT - 1) / CHAR_BIT;
+        uint8_t bytes[BYTES];
+
+        digitalWrite(LOAD, LOW);
+        digitalWrite(LOAD, HIGH);
+
+        SPI.beginTransaction(SPISettings(CLOCK, MSBFIRST, SPI_MODE0));
+        SPI.transfer(bytes, BYTES);
+        SPI.endTransaction();
+
+        for (size_t i = 0; i < BYTES; ++i)
+        {
+            uint8_t bits = IS_PULL_UP ? ~bytes[i] : bytes[i];
+
+            if ((i == (BYTES - 1)) && (BUTTONS_SIZE % CHAR_BIT))
+                bits &= (1 << (BUTTONS_SIZE % CHAR_BIT)) - 1; //unused inputs of the last register
+
+            data[i / sizeof(WORD)] |= static_cast<WORD>(bits) << ((i % sizeof(WORD)) * CHAR_BIT);
+        }
+    }
+};
+#endif
+
+//Pins given as template parameters
+template <uint8_t... PINS>
+struct Joystick_pins
+{
+    static constexpr size_t size = sizeof...(PINS);
+    static constexpr uint8_t values[sizeof...(PINS)] = {PINS...};
+
+    static uint_fast8_t pin(const size_t i) { return values[i]; }
+};
+
+template <uint8_t... PINS>
+constexpr uint8_t Joystick_pins<PINS...>::values[sizeof...(PINS)];
+
+//Scans a button matrix: every row of ROWS is driven low in turn and, SETTLE microseconds later, the pulled up COLUMNS read low
+//for its pressed buttons. Button (row * COLUMNS::size + column) is stored in data_buttons. Without DIODES, two rows sharing two or more
+//pressed columns may hold a ghost press, so these columns are masked in both rows. INCREMENTAL scans one row per read instead of all of them.
+template <class ROWS, class COLUMNS, uint_fast16_t SETTLE = 5, bool DIODES = true, bool INCREMENTAL = false>
+struct Joystick_matrix
+{
+    static_assert(COLUMNS::size <= 16, "A row of the matrix holds 16 columns at most");
+
+    detail::fast_pin columns[COLUMNS::size];
+    uint_fast16_t rows[ROWS::size] = {}; //pressed columns of every row
+    size_t next = 0;
+
+    template <bool IS_PULL_UP, class POLICY, size_t OFFSET>
+    void setup()
+    {
+        for (size_t i = 0; i < ROWS::size; ++i)
+            pinMode(ROWS::pin(i), INPUT);
+
+        for (size_t i = 0; i < COLUMNS::size; ++i)
+        {
+        #ifdef INPUT_PULLUP
+            pinMode(COLUMNS::pin(i), INPUT_PULLUP);
+        #else
+            pinMode(COLUMNS::pin(i), INPUT);
+        #endif
+            columns[i].attach(COLUMNS::pin(i));
+        }
+    }
+
+    //Idle rows are left floating, so pressed buttons of different rows never short two driven rows
+    uint_fast16_t scan(const size_t row)
+    {
+        uint_fast16_t pressed = 0;
+
+        pinMode(ROWS::pin(row), OUTPUT);
+        digitalWrite(ROWS::pin(row), LOW);
+        delayMicroseconds(SETTLE);
+
+        for (size_t i = 0; i < COLUMNS::size; ++i)
+        {
+            if (!columns[i].read())
+                pressed |= (static_cast<uint_fast16_t>(1) << i);
+        }
+
+        pinMode(ROWS::pin(row), INPUT);
+        return pressed;
+    }
+
+    template <size_t BUTTONS_SIZE, bool IS_PULL_UP, class WORD, size_t WORDS>
+    void read(WORD (&data)[WORDS])
+    {
+        static_assert(BUTTONS_SIZE == (ROWS::size * COLUMNS::size), "BUTTONS_SIZE must be the amount of rows times columns of the matrix");
+        static_assert(IS_PULL_UP, "The columns of the matrix are pulled up");
+
+        static constexpr size_t WORD_BITS = sizeof(WORD) * CHAR_BIT;
+
+        if (INCREMENTAL)
+        {
+            rows[next] = scan(next);
+            next = ((next + 1) < ROWS::size) ? (next + 1) : 0;
+        }
+        else
+        {
+            for (size_t i = 0; i < ROWS::size; ++i)
+                rows[i] = scan(i);
+        }
+
+        for (size_t i = 0; i < ROWS::size; ++i)
+        {
+            uint_fast16_t pressed = rows[i];
+
+            if (!DIODES)
+            {
+                for (size_t z = 0; z < ROWS::size; ++z)
+                {
+                    const uint_fast16_t shared = rows[i] & rows[z];
+
+                    if ((z != i) && (shared & (shared - 1)))
+                        pressed &= ~shared;
+                }
+            }
+
+            //A row spans two words at most
+            const size_t first = i * COLUMNS::size;
+            const size_t shift = first % WORD_BITS;
+
+            data[first / WORD_BITS] |= static_cast<WORD>(static_cast<WORD>(pressed) << shift);
+
+            if ((shift + COLUMNS::size) > WORD_BITS)
+                data[(first / WORD_BITS) + 1] |= static_cast<WORD>(pressed >> (WORD_BITS - shift));
+        }
+    }
+};
+
+//Reads the pins of PINS, a Joystick_pins<PINS...>, through their input registers resolved once in setup.
+//Like BUTTONS, pins of inverted buttons are given the opposite pull.
+template <class PINS>
+struct Joystick_pin_buttons
+{
+    detail::fast_pin pins[PINS::size];
+
+    template <bool IS_PULL_UP, class POLICY, size_t OFFSET>
+    void setup()
+    {
+        for (size_t i = 0; i < PINS::size; ++i)
+        {
+            pinMode(PINS::pin(i), detail::pull_mode(IS_PULL_UP != POLICY::inverted(OFFSET + i)));
+            pins[i].attach(PINS::pin(i));
+        }
+    }
+
+    template <size_t BUTTONS_SIZE, bool IS_PULL_UP, class WORD, size_t WORDS>
+    void read(WORD (&data)[WORDS])
+    {
+        static_assert(BUTTONS_SIZE == PINS::size, "Joystick_pin_buttons reads one button per pin");
+
+        for (size_t i = 0; i < PINS::size; ++i)
+        {
+            if (pins[i].read() != IS_PULL_UP)
+                data[i / (sizeof(WORD) * CHAR_BIT)] |= (static_cast<WORD>(1) << (i % (sizeof(WORD) * CHAR_BIT)));
+        }
+    }
+};
+
+//SIZE buttons read by SOURCE, a part of Joystick_button_sources
+template <size_t SIZE, class SOURCE>
+struct Joystick_buttons;
+
+//Reads the buttons of every part in turn, each stored right after the last one. Offsets are known at compile time,
+//so every part is read and shifted into data_buttons by straight-line code.
+template <class... PARTS>
+struct Joystick_button_sources;
+
+template <>
+struct Joystick_button_sources<>
+{
+    static constexpr size_t size = 0;
+
+    template <bool IS_PULL_UP, class POLICY, size_t OFFSET>
+    void setup() {}
+
+    template <size_t OFFSET, bool IS_PULL_UP, class WORD, size_t WORDS>
+    void read_at(WORD (&)[WORDS]) {}
+};
+
+template <size_t SIZE, class SOURCE, class... REST>
+struct Joystick_button_sources<Joystick_buttons<SIZE, SOURCE>, REST...> : Joystick_button_sources<REST...>
+{
+    typedef Joystick_button_sources<REST...> rest;
+
+    static constexpr size_t size = SIZE + rest::size;
+
+    SOURCE source;
+
+    template <bool IS_PULL_UP, class POLICY, size_t OFFSET>
+    void setup()
+    {
+        source.template setup<IS_PULL_UP, POLICY, OFFSET>();
+        rest::template setup<IS_PULL_UP, POLICY, OFFSET + SIZE>();
+    }
+
+    template <size_t BUTTONS_SIZE, bool IS_PULL_UP, class WORD, size_t WORDS>
+    void read(WORD (&data)[WORDS])
+    {
+        static_assert(BUTTONS_SIZE == size, "BUTTONS_SIZE must be the sum of the sizes of the parts");
+
+        read_at<0, IS_PULL_UP>(data);
+    }
+
+    template <size_t OFFSET, bool IS_PULL_UP, class WORD, size_t WORDS>
+    void read_at(WORD (&data)[WORDS])
+    {
+        static constexpr size_t WORD_BITS = sizeof(WORD) * CHAR_BIT;
+        static constexpr size_t FIRST = OFFSET / WORD_BITS;
+        static constexpr size_t SHIFT = OFFSET % WORD_BITS;
+
+        WORD part[detail::round_to_word<WORD>(SIZE)] = {0};
+        source.template read<SIZE, IS_PULL_UP>(part);
+
+        for (size_t i = 0; i < detail::round_to_word<WORD>(SIZE); ++i)
+        {
+            data[FIRST + i] |= static_cast<WORD>(part[i] << SHIFT);
+
+            if (SHIFT && ((FIRST + i + 1) < WORDS))
+                data[FIRST + i + 1] |= static_cast<WORD>(part[i] >> ((WORD_BITS - SHIFT) % WORD_BITS));
+        }
+
+        rest::template read_at<OFFSET + SIZE, IS_PULL_UP>(data);
+    }
+};
+
+#if defined(ESP32) || defined(ESP8266)
+    #define JOYSTICK_ISR IRAM_ATTR
+#else
+    #define JOYSTICK_ISR
+#endif
+
+//Quadrature encoder on pins A and B, both needing attachInterrupt. Every edge of either pin runs an interrupt decoding the Gray code
+//through a table; transitions skipping a state are ignored. STEPS is the amount of edges per detent. The channel is centered on 0x8000
+//and holds the detents turned since setup, or since the last read if RELATIVE.
+template <uint8_t A, uint8_t B, uint8_t STEPS = 4, bool RELATIVE = false>
+class Joystick_encoder
+{
+private:
+    static volatile long count;
+    static uint_fast8_t state;
+    static detail::fast_pin a;
+    static detail::fast_pin b;
+
+    long consumed = 0; //steps sent by written frames
+    long position = 0; //detents sent by written frames
+    long staged = 0; //detents put in frames not written yet
+
+    static void JOYSTICK_ISR change()
+    {
+        //Indexed by the last and current states, AB each
+        static const int8_t steps[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+
+        state = ((state << 2) | (a.read() << 1) | b.read()) & 0x0F;
+        count += steps[state];
+    }
+
+    //Detents not yet put in a frame; only whole detents are taken, the rest waits for the next read
+    long pending()
+    {
+        noInterrupts();
+        const long counted = count;
+        interrupts();
+
+        return ((counted - consumed) / STEPS) - staged;
+    }
+
+    template <class WORD>
+    WORD value(const long detents) const
+    {
+        return static_cast<WORD>(static_cast<uint16_t>(0x8000 + (RELATIVE ? detents : (position + staged + detents))));
+    }
+
+public:
+    void setup()
+    {
+    #ifdef INPUT_PULLUP
+        pinMode(A, INPUT_PULLUP);
+        pinMode(B, INPUT_PULLUP);
+    #else
+        pinMode(A, INPUT);
+        pinMode(B, INPUT);
+    #endif
+
+        a.attach(A);
+        b.attach(B);
+        state = (a.read() << 1) | b.read();
+
+        attachInterrupt(digitalPinToInterrupt(A), change, CHANGE);
+        attachInterrupt(digitalPinToInterrupt(B), change, CHANGE);
+    }
+
+    template <class WORD>
+    WORD channel()
+    {
+        return value<WORD>(pending());
+    }
+
+    //Channel put in a frame, its detents staged until the frame is written or dropped
+    template <class WORD>
+    WORD stage()
+    {
+        const long detents = pending();
+        const WORD channel = value<WORD>(detents);
+
+        staged += detents;
+        return channel;
+    }
+
+    //Detents of a dropped frame are sent again by the next one, so relative encoders never miss steps
+    void settle(const bool written)
+    {
+        if (written)
+        {
+            consumed += staged * STEPS;
+            position += staged;
+        }
+
+        staged = 0;
+    }
+};
+
+template <uint8_t A, uint8_t B, uint8_t STEPS, bool RELATIVE>
+volatile long Joystick_encoder<A, B, STEPS, RELATIVE>::count = 0;
+
+template <uint8_t A, uint8_t B, uint8_t STEPS, bool RELATIVE>
+uint_fast8_t Joystick_encoder<A, B, STEPS, RELATIVE>::state = 0;
+
+template <uint8_t A, uint8_t B, uint8_t STEPS, bool RELATIVE>
+detail::fast_pin Joystick_encoder<A, B, STEPS, RELATIVE>::a;
+
+template <uint8_t A, uint8_t B, uint8_t STEPS, bool RELATIVE>
+detail::fast_pin Joystick_encoder<A, B, STEPS, RELATIVE>::b;
+
+#undef JOYSTICK_ISR
+
+//Encoders sent after the potentiometers, one channel each
+template <class... ENCODERS>
+struct Joystick_encoders;
+
+template <>
+struct Joystick_encoders<>
+{
+    static constexpr size_t size = 0;
+
+    void setup() {}
+
+    template <class WORD>
+    void read(WORD*) {}
+
+    template <class WORD>
+    void stage(WORD*) {}
+
+    void settle(const bool) {}
+};
+
+template <class ENCODER, class... REST>
+struct Joystick_encoders<ENCODER, REST...> : Joystick_encoders<REST...>
+{
+    static constexpr size_t size = 1 + sizeof...(REST);
+
+    ENCODER encoder;
+
+    void setup()
+    {
+        encoder.setup();
+        Joystick_encoders<REST...>::setup();
+    }
+
+    template <class WORD>
+    void read(WORD* data)
+    {
+        *data = encoder.template channel<WORD>();
+        Joystick_encoders<REST...>::read(data + 1);
+    }
+
+    template <class WORD>
+    void stage(WORD* data)
+    {
+        *data = encoder.template stage<WORD>();
+        Joystick_encoders<REST...>::stage(data + 1);
+    }
+
+    void settle(const bool written)
+    {
+        encoder.settle(written);
+        Joystick_encoders<REST...>::settle(written);
+    }
+};
+
+//Four buttons sent as a POV hat in place of their bits, UP, RIGHT, DOWN and LEFT being buttons next to each other in any order.
+//The value is stored in the bits of the first of them.
+template <size_t UP, size_t RIGHT, size_t DOWN, size_t LEFT>
+struct Joystick_hat
+{
+    static constexpr size_t first = ((UP < RIGHT) ? UP : RIGHT) < ((DOWN < LEFT) ? DOWN : LEFT) ? ((UP < RIGHT) ? UP : RIGHT) : ((DOWN < LEFT) ? DOWN : LEFT);
+
+    static_assert((UP - first < 4) && (RIGHT - first < 4) && (DOWN - first < 4) && (LEFT - first < 4) && (((1 << (UP - first)) | (1 << (RIGHT - first)) | (1 << (DOWN - first)) | (1 << (LEFT - first))) == 0xF), "The buttons of a hat must be four different buttons next to each other");
+
+    template <size_t BUTTONS_SIZE, class WORD, size_t WORDS>
+    static void encode(WORD (&data)[WORDS])
+    {
+        static_assert(first + 4 <= BUTTONS_SIZE, "The buttons of a hat must be in BUTTONS");
+        //IBUS channels are 16 bits even when WORD is wider, as with uint_fast16_t on 32-bit boards
+        static_assert((first % 16) + 4 <= 16, "A hat must not straddle two channels");
+
+        const uint_fast8_t directions = bit<UP>(data) | (bit<RIGHT>(data) << 1) | (bit<DOWN>(data) << 2) | (bit<LEFT>(data) << 3);
+        const WORD value = detail::hat_table<>::values[directions];
+
+        data[first / (sizeof(WORD) * CHAR_BIT)] = (data[first / (sizeof(WORD) * CHAR_BIT)] & ~(static_cast<WORD>(0xF) << (first % (sizeof(WORD) * CHAR_BIT)))) | (value << (first % (sizeof(WORD) * CHAR_BIT)));
+    }
+
+private:
+    template <size_t BUTTON, class WORD, size_t WORDS>
+    static uint_fast8_t bit(const WORD (&data)[WORDS])
+    {
+        return (data[BUTTON / (sizeof(WORD) * CHAR_BIT)] >> (BUTTON % (sizeof(WORD) * CHAR_BIT))) & 1;
+    }
+};
+
+//Hats encoded by read once the buttons are read
+template <class... HATS>
+struct Joystick_hats;
+
+template <>
+struct Joystick_hats<>
+{
+    template <size_t BUTTONS_SIZE, class WORD, size_t WORDS>
+    static void encode(WORD (&)[WORDS]) {}
+};
+
+template <class HAT, class... REST>
+struct Joystick_hats<HAT, REST...>
+{
+    template <size_t BUTTONS_SIZE, class WORD, size_t WORDS>
+    static void encode(WORD (&data)[WORDS])
+    {
+        HAT::template encode<BUTTONS_SIZE>(data);
+        Joystick_hats<REST...>::template encode<BUTTONS_SIZE>(data);
+    }
+};
+
+//Button pressed once potentiometer POT reaches PRESS and released once it falls back to RELEASE, both in the range of data_pots.
+//With PRESS below RELEASE, the button is pressed at the low end instead. Without AXIS, POT is only sent as this button.
+template <size_t POT, uint_fast16_t PRESS, uint_fast16_t RELEASE, bool AXIS = true>
+struct Joystick_threshold
+{
+    static_assert(PRESS != RELEASE, "PRESS and RELEASE must differ to give the threshold some hysteresis");
+
+    static constexpr size_t pot = POT;
+    static constexpr bool axis = AXIS;
+
+    bool pressed = false;
+
+    template <class WORD>
+    bool update(const WORD value)
+    {
+        if (PRESS > RELEASE)
+            pressed = pressed ? (value > RELEASE) : (value >= PRESS);
+        else
+            pressed = pressed ? (value < RELEASE) : (value <= PRESS);
+
+        return pressed;
+    }
+};
+
+//Thresholds stored after the last button, one bit each
+template <class... THRESHOLDS>
+struct Joystick_thresholds;
 
-namespace detail
+template <>
+struct Joystick_thresholds<>
 {
-    // Primary template.
-    /// Define a member typedef @c type only if a boolean constant is true.
-    template<bool, typename _Tp = void>
-    struct enable_if 
-    { };
+    static constexpr size_t size = 0;
 
-    // Partial specialization for true.
-    template<typename _Tp>
-    struct enable_if<true, _Tp>
-    { typedef _Tp type; };
+    static constexpr bool sends(const size_t) { return true; }
+
+    template <class WORD, size_t POTS_SIZE, size_t WORDS>
+    void read(const WORD (&)[POTS_SIZE], WORD (&)[WORDS], const size_t) {}
+};
 
-    constexpr size_t round_to_fast16(const size_t bits)
+template <class THRESHOLD, class... REST>
+struct Joystick_thresholds<THRESHOLD, REST...> : Joystick_thresholds<REST...>
+{
+    static constexpr size_t size = 1 + sizeof...(REST);
+
+    THRESHOLD threshold;
+
+    static constexpr bool sends(const size_t pot)
     {
-        return bits % (sizeof(uint_fast16_t) * CHAR_BIT) ? ((bits/(sizeof(uint_fast16_t) * CHAR_BIT)) + 1) : (bits/(sizeof(uint_fast16_t) * CHAR_BIT));
+        return ((pot != THRESHOLD::pot) || THRESHOLD::axis) && Joystick_thresholds<REST...>::sends(pot);
     }
 
-    template <class T, size_t BUTTONS_SIZE, size_t POTS_SIZE, bool IS_PULL_UP>
-    class base_Joystick_BUTTONS
+    template <class WORD, size_t POTS_SIZE, size_t WORDS>
+    void read(const WORD (&pots)[POTS_SIZE], WORD (&buttons)[WORDS], const size_t bit)
     {
-    protected:
-        base_Joystick_BUTTONS() {}
-        uint_fast16_t data_buttons[detail::round_to_fast16(BUTTONS_SIZE)] = {0};
+        static_assert(THRESHOLD::pot < POTS_SIZE, "The potentiometer of a threshold must be in POTS");
 
-        template<bool value = IS_PULL_UP, typename detail::enable_if<value>::type* = nullptr>
-        void read_buttons() //PULL_UP
-        {
-            for (size_t i = 0; i < BUTTONS_SIZE;)
-            {
-                if (!digitalRead(JOYSTICK->BUTTONS[i]))
-                {
-                    ++i;
-                    data_buttons[detail::round_to_fast16(i) - 1] |= (1 << (((i % (sizeof(uint_fast16_t) * CHAR_BIT)) ? (i % (sizeof(uint_fast16_t) * CHAR_BIT)) : (sizeof(uint_fast16_t) * CHAR_BIT)) - 1));
-                    continue;
-                }
+        const size_t index = bit / (sizeof(WORD) * CHAR_BIT);
+        const WORD mask = static_cast<WORD>(1) << (bit % (sizeof(WORD) * CHAR_BIT));
 
-                ++i;
-            }
-        }
+        buttons[index] = threshold.update(pots[THRESHOLD::pot]) ? (buttons[index] | mask) : (buttons[index] & ~mask);
+        Joystick_thresholds<REST...>::read(pots, buttons, bit + 1);
+    }
+};
 
-        template<bool value = IS_PULL_UP, typename detail::enable_if<!value>::type* = nullptr>
-        void read_buttons() //PULL_DOWN
-        {
-            for (size_t i = 0; i < BUTTONS_SIZE;)
-            {
-                if (digitalRead(JOYSTICK->BUTTONS[i]))
-                {
-                    ++i;
-                    data_buttons[detail::round_to_fast16(i) - 1] |= (1 << (((i % (sizeof(uint_fast16_t) * CHAR_BIT)) ? (i % (sizeof(uint_fast16_t) * CHAR_BIT)) : (sizeof(uint_fast16_t) * CHAR_BIT)) - 1));
-                    continue;
-                }
+//Converts every potentiometer on every read
+struct Joystick_every_read
+{
+    template <class POLICY, size_t POTS_SIZE>
+    struct schedule
+    {
+        void start() {}
+        bool due(const size_t) { return true; }
+        typename POLICY::storage_type hold(const size_t, const typename POLICY::storage_type value) { return value; }
+        typename POLICY::storage_type held(const size_t) { return 0; }
+    };
+};
 
-                ++i;
-            }
-        }
+//Converts each potentiometer at most once every PERIODS microseconds and holds its value in between.
+//Takes one period for every potentiometer, or a single one for all of them.
+template <unsigned long... PERIODS>
+struct Joystick_pot_periods
+{
+    static constexpr unsigned long periods[sizeof...(PERIODS)] = {PERIODS...};
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b >= value_p)>::type* = nullptr>
-        void print_buttons()
-        {
-            JOYSTICK->printComma = &T::printComma_;
+    template <class POLICY, size_t POTS_SIZE>
+    class schedule
+    {
+    private:
+        static_assert((sizeof...(PERIODS) == 1) || (sizeof...(PERIODS) == POTS_SIZE), "Give one period for every potentiometer, or a single one for all of them");
 
-            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
-                
-                Serial.print(JOYSTICK->BUTTONS[i]);
-                Serial.print(":");
-                Serial.print(bitRead(data_buttons[i / (sizeof(uint_fast16_t) * CHAR_BIT)], i % (sizeof(uint_fast16_t) * CHAR_BIT)));
-            }
+        typename POLICY::storage_type values[POTS_SIZE] = {};
+        unsigned long last[POTS_SIZE] = {};
+        unsigned long now = 0;
+        bool primed = false;
+        bool first = true;
 
-            Serial.println();
+    public:
+        void start()
+        {
+            now = micros();
+            first = !primed;
+            primed = true;
         }
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_p > value_b)>::type* = nullptr>
-        void print_buttons()
+        bool due(const size_t i)
         {
-            JOYSTICK->printComma = &T::printComma_;
+            if (!first && ((now - last[i]) < periods[(sizeof...(PERIODS) == 1) ? 0 : i]))
+                return false;
 
-            for (size_t i = 0; i < BUTTONS_SIZE; ++i)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
-                
-                Serial.print(JOYSTICK->BUTTONS[i]);
-                Serial.print(":");
-                Serial.print(bitRead(data_buttons[i / (sizeof(uint_fast16_t) * CHAR_BIT)], i % (sizeof(uint_fast16_t) * CHAR_BIT)));
-            }
+            last[i] = now;
+            return true;
+        }
 
-            for (size_t i = 0; i < POTS_SIZE - BUTTONS_SIZE; ++i)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
-                Serial.print("N/A:0");
-            }
-            
-            Serial.println();
+        typename POLICY::storage_type hold(const size_t i, const typename POLICY::storage_type value) { return values[i] = value; }
+        typename POLICY::storage_type held(const size_t i) { return values[i]; }
+    };
+};
+
+template <unsigned long... PERIODS>
+constexpr unsigned long Joystick_pot_periods<PERIODS...>::periods[sizeof...(PERIODS)];
+
+//Converts moving potentiometers on every read. A potentiometer changing by THRESHOLD or less for IDLE_AFTER conversions in a row goes idle
+//and is only converted once every IDLE_PERIOD microseconds, until a conversion changes by more than THRESHOLD.
+//Movements of an idle potentiometer are therefore delayed by IDLE_PERIOD at most.
+template <unsigned long IDLE_PERIOD, uint_fast16_t THRESHOLD = 8, uint_fast8_t IDLE_AFTER = 32>
+struct Joystick_adaptive_schedule
+{
+    template <class POLICY, size_t POTS_SIZE>
+    class schedule
+    {
+    private:
+        typename POLICY::storage_type values[POTS_SIZE] = {};
+        unsigned long last[POTS_SIZE] = {};
+        uint_fast8_t still[POTS_SIZE] = {}; //conversions in a row within THRESHOLD, up to IDLE_AFTER
+        unsigned long now = 0;
+
+    public:
+        void start()
+        {
+            now = micros();
         }
 
-        template<bool value = IS_PULL_UP, typename detail::enable_if<value>::type* = nullptr>
-        void setup_buttons() //PULL_UP
+        bool due(const size_t i)
         {
-        #ifdef INPUT_PULLUP
-            for (const auto itr : JOYSTICK->BUTTONS)
-                pinMode(itr, INPUT_PULLUP);
-        #else
-            #warning INPUT_PULLUP is not defined, falling back to INPUT
-            for (const auto itr : JOYSTICK->BUTTONS)
-                pinMode(itr, INPUT);
-        #endif
+            if ((still[i] >= IDLE_AFTER) && ((now - last[i]) < IDLE_PERIOD))
+                return false;
+
+            last[i] = now;
+            return true;
         }
 
-        template<bool value = IS_PULL_UP, typename detail::enable_if<!value>::type* = nullptr>
-        void setup_buttons() //PULL_DOWN
+        typename POLICY::storage_type hold(const size_t i, const typename POLICY::storage_type value)
         {
-        #ifdef INPUT_PULLDOWN
-            for (const auto itr : JOYSTICK->BUTTONS)
-                pinMode(itr, INPUT_PULLDOWN);
-        #else
-            #warning INPUT_PULLDOWN is not defined, falling back to INPUT
-            for (const auto itr : JOYSTICK->BUTTONS)
-                pinMode(itr, INPUT);
-        #endif
+            const typename POLICY::compute_type change = (value > values[i]) ? (value - values[i]) : (values[i] - value);
+
+            still[i] = (change > THRESHOLD) ? 0 : ((still[i] < IDLE_AFTER) ? (still[i] + 1) : IDLE_AFTER);
+            return values[i] = value;
         }
+
+        typename POLICY::storage_type held(const size_t i) { return values[i]; }
+    };
+};
+
+//Passes the potentiometer values through unchanged
+struct Joystick_no_filter
+{
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    struct stage
+    {
+        void operator()(typename POLICY::storage_type (&)[POTS_SIZE]) {}
     };
+};
 
-    template <class T, size_t POTS_SIZE, bool IS_PULL_UP>
-    class base_Joystick_BUTTONS<T, 0, POTS_SIZE, IS_PULL_UP> {};
+//Average of the last (1 << SHIFT) values of every potentiometer
+template <uint_fast8_t SHIFT>
+struct Joystick_boxcar_filter
+{
+    static_assert(SHIFT < 8, "SHIFT must be less than 8");
 
-    template <class T, size_t BUTTONS_SIZE, size_t POTS_SIZE>
-    class base_Joystick_POTS
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    class stage
     {
     private:
-        void calibrate()
-        {
-            for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
-            {
-                JOYSTICK->CALIBRATION[i] = -1; //min - standard enforces 2s complement for unsinged variables
-                JOYSTICK->CALIBRATION[++i] = 0; //max
-            }
+        typedef detail::pot_lanes<POTS_SIZE, MAX_VALUE, SHIFT> lanes;
+        typedef typename lanes::word word;
 
-            Serial.println("Adjust the potentiometers to reach their maximum and minimum values.");
-            Serial.println("Once finished input any character into the Serial Monitor.");
-            Serial.println();
+        word ring[1 << SHIFT][lanes::size] = {};
+        word sum[lanes::size] = {};
+        uint_fast8_t index = 0;
+        bool primed = false;
 
-            while (Serial.available())
-                Serial.read();
-
-            while (!Serial.available())
+    public:
+        void operator()(typename POLICY::storage_type (&data)[POTS_SIZE])
+        {
+            for (size_t i = 0, z = 0; z < lanes::size; i += lanes::count, ++z)
             {
-                for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
-                {
-                    uint_fast16_t value = analogRead(JOYSTICK->POTS[i/2]);
-
-                    if (value < JOYSTICK->CALIBRATION[i])
-                    {
-                        JOYSTICK->CALIBRATION[i] = value;
-                        ++i;
-                        continue;
-                    }
-
-                    if (value > JOYSTICK->CALIBRATION[++i])
-                    {
-                        JOYSTICK->CALIBRATION[i] = value;
-                    }
-                }
-            }
+                const word value = lanes::pack(data, i);
 
-            for (size_t i = 0; i < (POTS_SIZE * 2); ++i)
-            {
-                if (JOYSTICK->CALIBRATION[i] == JOYSTICK->CALIBRATION[i + 1])
+                if (!primed) //fill the ring so the axes don't rise from 0
                 {
-                    Serial.print("Potentiometer PIN_");
-                    Serial.print(JOYSTICK->POTS[i/2]);
-                    Serial.println(" has same MIN and MAX.");
-                    Serial.println("Defaulting to min and max values");
-                    Serial.println();
-
-                    JOYSTICK->CALIBRATION[i] = 0;
-                    JOYSTICK->CALIBRATION[++i] = -1; //standard enforces 2s complement for unsinged variables
-                    continue;
-                }
+                    for (auto& itr : ring)
+                        itr[z] = value;
 
-                ++i;
-            }
-
-            Serial.print("Calibration complete, the values are: ");
+                    sum[z] = value << SHIFT;
+                }
 
-            JOYSTICK->printComma = &T::printComma_;
+                sum[z] += value - ring[index][z];
+                ring[index][z] = value;
 
-            for (const auto itr : JOYSTICK->CALIBRATION)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
-                Serial.print(itr);
+                lanes::unpack(data, i, (sum[z] >> SHIFT) & lanes::mask);
             }
 
-            Serial.println();
-            Serial.println();
-
-            Serial.println("Use these values for the CALIBRATION variable to prevent this procedure.");
-            Serial.println();
+            primed = true;
+            index = (index + 1) & ((1 << SHIFT) - 1);
         }
+    };
+};
 
-    protected:
-        base_Joystick_POTS() {}
-        uint_fast16_t data_pots[POTS_SIZE] = {0};
+//Exponential moving average with a weight of 1 / (1 << SHIFT) for every new value
+template <uint_fast8_t SHIFT>
+struct Joystick_exponential_filter
+{
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    class stage
+    {
+    private:
+        typedef detail::pot_lanes<POTS_SIZE, MAX_VALUE, SHIFT> lanes;
+        typedef typename lanes::word word;
+
+        word average[lanes::size] = {}; //value << SHIFT
+        bool primed = false;
 
-        void read_pots() //improper calibration (negative value) will overflow to max value (65,535 --> BIT_RESOLUTION_MAX_VALUE)
+    public:
+        void operator()(typename POLICY::storage_type (&data)[POTS_SIZE])
         {
-            for (size_t i = 0, count = 0; i < POTS_SIZE; ++i, count += 2)
+            for (size_t i = 0, z = 0; z < lanes::size; i += lanes::count, ++z)
             {
-                uint_fast16_t value = map(analogRead(JOYSTICK->POTS[i]), JOYSTICK->CALIBRATION[count], JOYSTICK->CALIBRATION[count + 1], 0, BIT_RESOLUTION_MAX_VALUE);
-                value = (value > BIT_RESOLUTION_MAX_VALUE) ? BIT_RESOLUTION_MAX_VALUE : value;
+                const word value = lanes::pack(data, i);
 
-                data_pots[i] = value;
+                average[z] = primed ? (average[z] - ((average[z] >> SHIFT) & lanes::mask) + value) : (value << SHIFT);
+                lanes::unpack(data, i, (average[z] >> SHIFT) & lanes::mask);
             }
+
+            primed = true;
         }
+    };
+};
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_p >= value_b)>::type* = nullptr>
-        void print_pots()
-        {
-            JOYSTICK->printComma = &T::printComma_;
+//Parameters of one potentiometer for Joystick_one_euro_filter
+//MIN_ALPHA is the weight of a new value at rest, out of 256 (lower is smoother)
+//BETA is the weight added per unit of speed (change per read), out of 256 (higher follows fast movements closer)
+//SPEED_SHIFT smooths the speed over about (1 << SPEED_SHIFT) reads
+template <uint_fast8_t MIN_ALPHA, uint_fast8_t BETA, uint_fast8_t SPEED_SHIFT = 2>
+struct Joystick_one_euro
+{
+    static_assert(MIN_ALPHA > 0, "MIN_ALPHA must be greater than 0");
+    static_assert(SPEED_SHIFT < 8, "SPEED_SHIFT must be less than 8");
 
-            for (size_t i = 0; i < POTS_SIZE; ++i)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
+    static constexpr int_fast32_t min_alpha = MIN_ALPHA;
+    static constexpr int_fast32_t beta = BETA;
+    static constexpr uint_fast8_t speed_shift = SPEED_SHIFT;
+};
 
-                Serial.print(JOYSTICK->POTS[i]);
-                Serial.print(":");
-                Serial.print(data_pots[i]);
-            }
-            
-            Serial.println();
-        }
+//One Euro filter: smoothing is heavy while a potentiometer rests and fades as it moves faster.
+//Takes one Joystick_one_euro for every potentiometer, or a single one for all of them.
+template <class... AXES>
+struct Joystick_one_euro_filter
+{
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    class stage
+    {
+    private:
+        template <class...> friend struct detail::per_axis;
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b > value_p)>::type* = nullptr>
-        void print_pots()
-        {
-            JOYSTICK->printComma = &T::printComma_;
+        //fraction bits kept so the products below fit in 31 bits
+        static constexpr uint_fast8_t FRAC = (detail::bit_width(MAX_VALUE) < 22) ? (22 - detail::bit_width(MAX_VALUE)) : 0;
 
-            for (size_t i = 0; i < POTS_SIZE; ++i)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
+        int_fast32_t value[POTS_SIZE] = {}; //value << FRAC
+        int_fast32_t speed[POTS_SIZE] = {}; //change per read << FRAC
+        bool primed = false;
 
-                Serial.print(JOYSTICK->POTS[i]);
-                Serial.print(":");
-                Serial.print(data_pots[i]);
-            }
+        template <class AXIS>
+        void update(typename POLICY::storage_type& data, const size_t i)
+        {
+            const int_fast32_t input = static_cast<int_fast32_t>(data) << FRAC;
 
-            for (size_t i = 0; i < BUTTONS_SIZE - POTS_SIZE; ++i)
-            {
-                (JOYSTICK->*(JOYSTICK->printComma))();
-                Serial.print("N/A:0");
-            }
+            speed[i] += ((input - value[i]) - speed[i]) >> AXIS::speed_shift;
+
+            int_fast32_t alpha = AXIS::min_alpha + ((AXIS::beta * (speed[i] < 0 ? -speed[i] : speed[i])) >> FRAC);
+            alpha = alpha < 256 ? alpha : 256;
 
-            Serial.println();
+            value[i] += ((input - value[i]) * alpha) >> 8;
+            data = (value[i] + ((static_cast<int_fast32_t>(1) << FRAC) >> 1)) >> FRAC;
         }
 
-        void setup_pots()
+    public:
+        void operator()(typename POLICY::storage_type (&data)[POTS_SIZE])
         {
-            for (const auto itr : JOYSTICK->POTS)
-                pinMode(itr, INPUT);
-
-            for (const auto itr : JOYSTICK->CALIBRATION)
+            if (!primed) //start at rest on the first value read
             {
-                if (itr != 0)
-                    return;
+                for (size_t i = 0; i < POTS_SIZE; ++i)
+                    value[i] = static_cast<int_fast32_t>(data[i]) << FRAC;
+
+                primed = true;
             }
 
-            calibrate();
+            detail::per_axis<AXES...>::apply(*this, data);
         }
     };
+};
 
-    #undef BIT_RESOLUTION_MAX_VALUE
+//Base of every response curve. The curve is stored as a table of SEGMENTS + 1 points, interpolated between them unless INTERPOLATE is false.
+//A custom curve derives from it and defines static constexpr value(x), mapping x from 0 to 0xFFFF into 0 to 0xFFFF.
+template <size_t SEGMENTS = 32, bool INTERPOLATE = true>
+struct Joystick_curve
+{
+    static constexpr size_t segments = SEGMENTS;
+    static constexpr bool interpolate = INTERPOLATE;
+};
 
-    template <class T, size_t BUTTONS_SIZE>
-    class base_Joystick_POTS<T, BUTTONS_SIZE, 0> {};
+//Expo around the middle: EXPO of 0 is linear, 256 is cubic
+template <uint_fast16_t EXPO, size_t SEGMENTS = 32, bool INTERPOLATE = true>
+struct Joystick_expo_curve : Joystick_curve<SEGMENTS, INTERPOLATE>
+{
+    static_assert(EXPO <= 256, "EXPO must be 256 or less");
 
-    template <class T, size_t BUTTONS_SIZE, size_t POTS_SIZE, bool IS_PULL_UP>
-    class base_Joystick : protected base_Joystick_BUTTONS<T, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>, protected base_Joystick_POTS<T, BUTTONS_SIZE, POTS_SIZE>
+    //x from -0xFFFF to 0xFFFF
+    static constexpr long long centered(const long long x)
     {
-    protected:
-        base_Joystick() {}
+        return ((x * (256 - static_cast<long long>(EXPO))) + (((x * x * x) / (0xFFFFll * 0xFFFF)) * static_cast<long long>(EXPO))) / 256;
+    }
 
-        void (base_Joystick::*printComma)();
-        void printComma_() { printComma = &base_Joystick::printComma__; }
-        void printComma__() { Serial.print(", "); }
+    static constexpr unsigned long long value(const unsigned long long x)
+    {
+        return (centered((static_cast<long long>(x) * 2) - 0xFFFF) + 0xFFFF) / 2;
+    }
+};
 
-        void (base_Joystick::*print_)() = &base_Joystick::print__;
+//Straight lines through evenly spaced POINTS, from 0 to 0xFFFF
+template <uint_fast16_t... POINTS>
+struct Joystick_points_curve : Joystick_curve<sizeof...(POINTS) - 1>
+{
+    static_assert(sizeof...(POINTS) >= 2, "Joystick_points_curve needs at least 2 POINTS");
 
-        void print__()
-        { 
-            while (Serial.available())
-                Serial.read();
+    static constexpr unsigned long long nth(const size_t, const unsigned long long first)
+    {
+        return first;
+    }
 
-            Serial.println("Enter 0 to print buttons or 1 to print potentiometers.");
-            Serial.println("You are able to switch between the two, just enter the value into Serial later.");
-            Serial.println();
+    template <class... REST>
+    static constexpr unsigned long long nth(const size_t i, const unsigned long long first, const REST... rest)
+    {
+        return i ? nth(i - 1, rest...) : first;
+    }
 
-            while (!Serial.available()) {}
-            JOYSTICK->determine_print();
-        }
+    //the table holds exactly one point per segment, so it is only called on the POINTS
+    static constexpr unsigned long long value(const unsigned long long x)
+    {
+        return nth(((x * (sizeof...(POINTS) - 1)) + 0x7FFF) / 0xFFFF, POINTS...);
+    }
+};
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b > 0 && value_p > 0)>::type* = nullptr>
-        void send_data()
+//Shapes every potentiometer with a response curve from a table, applied once per read.
+//Takes one curve for every potentiometer, or a single one for all of them.
+template <class... CURVES>
+struct Joystick_curve_filter
+{
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    class stage
+    {
+    private:
+        template <class...> friend struct detail::per_axis;
+
+        template <class CURVE, typename detail::enable_if<CURVE::interpolate>::type* = nullptr>
+        void update(typename POLICY::storage_type& data, const size_t)
         {
-            Serial.write(4 + (detail::round_to_fast16(BUTTONS_SIZE) * sizeof(uint_fast16_t)) + (POTS_SIZE * sizeof(uint_fast16_t)));
-            Serial.write(0x40);
+            typedef detail::curve_table<CURVE, MAX_VALUE> table;
 
-            uint_fast16_t checksum = 0xffff - (4 + (detail::round_to_fast16(BUTTONS_SIZE) * sizeof(uint_fast16_t)) + (POTS_SIZE * sizeof(uint_fast16_t))) - 0x40;
+            const uint_fast32_t position = (static_cast<uint_fast32_t>(data < MAX_VALUE ? data : MAX_VALUE) * table::factor) >> 16;
+            const uint_fast16_t i = position >> table::frac;
+            const uint_fast16_t weight = position & ((static_cast<uint_fast16_t>(1) << table::frac) - 1);
 
-            for (size_t i = 0; i < detail::round_to_fast16(BUTTONS_SIZE); ++i)
-            {
-                for (size_t z = 0; z < sizeof(uint_fast16_t); ++z)
-                {
-                    Serial.write((uint8_t)this->data_buttons[i]);
-                    checksum -= (uint8_t)this->data_buttons[i];
-                    this->data_buttons[i] = (this->data_buttons[i] >> CHAR_BIT);
-                }
-            }
+            data = ((static_cast<uint_fast32_t>(table::values[i]) * ((static_cast<uint_fast16_t>(1) << table::frac) - weight)) + (static_cast<uint_fast32_t>(table::values[i + 1]) * weight)) >> table::frac;
+        }
 
-            for (size_t i = 0; i < POTS_SIZE; ++i)
-            {
-                for (size_t z = 0; z < sizeof(uint_fast16_t); ++z)
-                {
-                    Serial.write((uint8_t)this->data_pots[i]);
-                    checksum -= (uint8_t)this->data_pots[i];
-                    this->data_pots[i] = (this->data_pots[i] >> CHAR_BIT);
-                }
-            }
+        template <class CURVE, typename detail::enable_if<!CURVE::interpolate>::type* = nullptr>
+        void update(typename POLICY::storage_type& data, const size_t)
+        {
+            typedef detail::curve_table<CURVE, MAX_VALUE> table;
 
-            for (size_t i = 0; i < sizeof(checksum); ++i)
-            {
-                Serial.write((uint8_t)checksum);
-                checksum = checksum >> CHAR_BIT;
-            }
+            const uint_fast32_t position = (static_cast<uint_fast32_t>(data < MAX_VALUE ? data : MAX_VALUE) * table::factor) >> 16;
+            data = table::values[(position + (static_cast<uint_fast32_t>(1) << (table::frac - 1))) >> table::frac]; //nearest point
         }
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b > 0 && value_p == 0)>::type* = nullptr>
-        void send_data()
+    public:
+        void operator()(typename POLICY::storage_type (&data)[POTS_SIZE])
         {
-            Serial.write(4 + (detail::round_to_fast16(BUTTONS_SIZE) * sizeof(uint_fast16_t)));
-            Serial.write(0x40);
+            detail::per_axis<CURVES...>::apply(*this, data);
+        }
+    };
+};
 
-            uint_fast16_t checksum = 0xffff - (4 + (detail::round_to_fast16(BUTTONS_SIZE) * sizeof(uint_fast16_t))) - 0x40;
+//Holds every potentiometer value until it moves more than BAND away from the value last reported, or reaches 0 or MAX_VALUE.
+//Then applies a deadzone of CENTER around the middle and of EDGE at both ends, stretching the rest back to the full range.
+template <uint_fast16_t BAND, uint_fast16_t CENTER = 0, uint_fast16_t EDGE = 0>
+struct Joystick_deadband_filter
+{
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    class stage
+    {
+    private:
+        static constexpr int_fast32_t MIDDLE = MAX_VALUE / 2;
+        static constexpr int_fast32_t BELOW = MIDDLE; //range below MIDDLE
+        static constexpr int_fast32_t ABOVE = MAX_VALUE - MIDDLE; //range above MIDDLE
+        static constexpr int_fast32_t SPAN = BELOW - static_cast<int_fast32_t>(CENTER) - static_cast<int_fast32_t>(EDGE); //range outside of the deadzones on each side
 
-            for (size_t i = 0; i < detail::round_to_fast16(BUTTONS_SIZE); ++i)
-            {
-                for (size_t z = 0; z < sizeof(uint_fast16_t); ++z)
-                {
-                    Serial.write((uint8_t)this->data_buttons[i]);
-                    checksum -= (uint8_t)this->data_buttons[i];
-                    this->data_buttons[i] = (this->data_buttons[i] >> CHAR_BIT);
-                }
-            }
+        static_assert(SPAN > 0, "CENTER and EDGE deadzones must leave some range");
 
-            for (size_t i = 0; i < sizeof(checksum); ++i)
-            {
-                Serial.write((uint8_t)checksum);
-                checksum = checksum >> CHAR_BIT;
-            }
-        }
+        //rounded up so SPAN reaches BELOW and ABOVE
+        static constexpr uint_fast32_t BELOW_FACTOR = ((static_cast<uint_fast32_t>(BELOW) << 16) / SPAN) + 1;
+        static constexpr uint_fast32_t ABOVE_FACTOR = ((static_cast<uint_fast32_t>(ABOVE) << 16) / SPAN) + 1;
 
-        template<size_t value_b = BUTTONS_SIZE, size_t value_p = POTS_SIZE, typename detail::enable_if<(value_b == 0 && value_p > 0)>::type* = nullptr>
-        void send_data()
+        typename POLICY::storage_type reported[POTS_SIZE] = {};
+        bool primed = false;
+
+    public:
+        void operator()(typename POLICY::storage_type (&data)[POTS_SIZE])
         {
-            Serial.write(4 + (POTS_SIZE * sizeof(uint_fast16_t)));
-            Serial.write(0x40);
+            if (BAND)
+            {
+                if (!primed)
+                {
+                    for (size_t i = 0; i < POTS_SIZE; ++i)
+                        reported[i] = data[i];
 
-            uint_fast16_t checksum = 0xffff - (4 + (POTS_SIZE * sizeof(uint_fast16_t))) - 0x40;
+                    primed = true;
+                }
 
-            for (size_t i = 0; i < POTS_SIZE; ++i)
-            {
-                for (size_t z = 0; z < sizeof(uint_fast16_t); ++z)
+                for (size_t i = 0; i < POTS_SIZE; ++i)
                 {
-                    Serial.write((uint8_t)this->data_pots[i]);
-                    checksum -= (uint8_t)this->data_pots[i];
-                    this->data_pots[i] = (this->data_pots[i] >> CHAR_BIT);
+                    const int_fast32_t value = data[i];
+                    const int_fast32_t change = value - static_cast<int_fast32_t>(reported[i]);
+                    const bool moved = (change > static_cast<int_fast32_t>(BAND)) | (change < -static_cast<int_fast32_t>(BAND)) | (value == 0) | (value == static_cast<int_fast32_t>(MAX_VALUE));
+
+                    //select without branching: all ones when moved
+                    const typename POLICY::storage_type mask = -static_cast<typename POLICY::storage_type>(moved);
+                    reported[i] ^= (reported[i] ^ data[i]) & mask;
+                    data[i] = reported[i];
                 }
             }
 
-            for (size_t i = 0; i < sizeof(checksum); ++i)
+            if (CENTER || EDGE)
             {
-                Serial.write((uint8_t)checksum);
-                checksum = checksum >> CHAR_BIT;
+                for (auto& itr : data)
+                {
+                    const int_fast32_t offset = static_cast<int_fast32_t>(itr) - MIDDLE;
+                    const bool high = offset > 0;
+
+                    int_fast32_t distance = (high ? offset : -offset) - static_cast<int_fast32_t>(CENTER);
+                    distance = distance > 0 ? distance : 0;
+                    distance = distance < SPAN ? distance : SPAN;
+                    distance = (static_cast<uint_fast32_t>(distance) * (high ? ABOVE_FACTOR : BELOW_FACTOR)) >> 16;
+
+                    itr = high ? (MIDDLE + distance) : (MIDDLE - distance);
+                }
             }
         }
     };
-}
+};
 
-#undef JOYSTICK
+//Applies every filter in order, e.g. Joystick_filters<Joystick_exponential_filter<2>, Joystick_deadband_filter<2>>
+template <class... FILTERS>
+struct Joystick_filters
+{
+    template <class POLICY, size_t POTS_SIZE, uint_fast32_t MAX_VALUE>
+    using stage = detail::filter_chain<POLICY, POTS_SIZE, MAX_VALUE, FILTERS...>;
+};
 
-template <size_t BUTTONS_SIZE, size_t POTS_SIZE, bool IS_PULL_UP = true>
-class Joystick : private detail::base_Joystick<Joystick<BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>
+template <size_t BUTTONS_SIZE, size_t POTS_SIZE, bool IS_PULL_UP = true, size_t PROFILES = 1, class POLICY = Joystick_policy>
+class Joystick : private detail::base_Joystick<Joystick<BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>
 {
 private:
-    friend class detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>;
-    friend class detail::base_Joystick_BUTTONS<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>;
-    friend class detail::base_Joystick_POTS<Joystick, BUTTONS_SIZE, POTS_SIZE>;
+    friend class detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>;
+    friend class detail::base_Joystick_BUTTONS<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, POLICY>;
+    friend class detail::base_Joystick_POTS<Joystick, BUTTONS_SIZE, POTS_SIZE, PROFILES, POLICY>;
 
     const uint_fast8_t (&BUTTONS)[BUTTONS_SIZE];
     const uint_fast8_t (&POTS)[POTS_SIZE];
-    uint_fast16_t (&CALIBRATION)[POTS_SIZE * 2];
+    typename POLICY::storage_type (&CALIBRATION)[POTS_SIZE * 2 * PROFILES];
 
     void determine_print()
     {
-        switch (Serial.read())
+        switch (POLICY::console().read())
         {
             case 48: //0
-                this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>::*)()>(&Joystick::template print_buttons<BUTTONS_SIZE, POTS_SIZE>);
+                this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>::*)()>(&Joystick::template print_buttons<BUTTONS_SIZE, POTS_SIZE>);
                 break;
             case 49: //1
-                this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>::*)()>(&Joystick::template print_pots<BUTTONS_SIZE, POTS_SIZE>);
+                this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>::*)()>(&Joystick::template print_pots<BUTTONS_SIZE, POTS_SIZE>);
                 break;
             default:
-                Serial.println("Invalid input.");
-                Serial.println();
+                POLICY::console().println("Invalid input.");
+                POLICY::console().println();
                 break;
         }
     }
 
 public:
-    Joystick(const uint_fast8_t (&BUTTONS)[BUTTONS_SIZE], const uint_fast8_t (&POTS)[POTS_SIZE], uint_fast16_t (&CALIBRATION)[POTS_SIZE * 2])
+    Joystick(const uint_fast8_t (&BUTTONS)[BUTTONS_SIZE], const uint_fast8_t (&POTS)[POTS_SIZE], typename POLICY::storage_type (&CALIBRATION)[POTS_SIZE * 2 * PROFILES])
         : BUTTONS(BUTTONS), POTS(POTS), CALIBRATION(CALIBRATION)
     {}
 
@@ -453,16 +2394,19 @@ public:
     {
         this->setup_buttons();
         this->setup_pots();
+        this->setup_encoders();
     }
 
     //Read button and potentiometer values
     void read()
     {
         memset(this->data_buttons, 0, sizeof(this->data_buttons));
-        memset(this->data_pots, 0, sizeof(this->data_pots));
 
+        this->start_pots();
         this->read_buttons();
         this->read_pots();
+        this->read_thresholds();
+        this->read_encoders();
     }
 
     //Designed for Serial Plotter
@@ -470,15 +2414,15 @@ public:
     {
         (this->*(this->print_))();
 
-        while (Serial.available())
+        while (POLICY::console().available())
         {
-            switch (Serial.read())
+            switch (POLICY::console().read())
             {
                 case 48: //0
-                    this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>::*)()>(&Joystick::template print_buttons<BUTTONS_SIZE, POTS_SIZE>);
+                    this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>::*)()>(&Joystick::template print_buttons<BUTTONS_SIZE, POTS_SIZE>);
                     break;
                 case 49: //1
-                    this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP>::*)()>(&Joystick::template print_pots<BUTTONS_SIZE, POTS_SIZE>);
+                    this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>::*)()>(&Joystick::template print_pots<BUTTONS_SIZE, POTS_SIZE>);
                     break;
             }
         }
@@ -488,33 +2432,45 @@ public:
     {
         this->send_data();
     }
+
+    //Frames skipped by send as the port was busy
+    uint_fast32_t dropped_frames() const
+    {
+        return this->drops;
+    }
+
+    //Switch to another set of calibration values
+    void select_profile(const size_t index)
+    {
+        this->select_pots_profile(index);
+    }
 };
 
-template <size_t BUTTONS_SIZE, bool IS_PULL_UP>
-class Joystick<BUTTONS_SIZE, 0, IS_PULL_UP> : private detail::base_Joystick<Joystick<BUTTONS_SIZE, 0, IS_PULL_UP>, BUTTONS_SIZE, 0, IS_PULL_UP>
+template <size_t BUTTONS_SIZE, bool IS_PULL_UP, size_t PROFILES, class POLICY>
+class Joystick<BUTTONS_SIZE, 0, IS_PULL_UP, PROFILES, POLICY> : private detail::base_Joystick<Joystick<BUTTONS_SIZE, 0, IS_PULL_UP, PROFILES, POLICY>, BUTTONS_SIZE, 0, IS_PULL_UP, PROFILES, POLICY>
 {
 private:
-    friend class detail::base_Joystick<Joystick, BUTTONS_SIZE, 0, IS_PULL_UP>;
-    friend class detail::base_Joystick_BUTTONS<Joystick, BUTTONS_SIZE, 0, IS_PULL_UP>;
-    friend class detail::base_Joystick_POTS<Joystick, BUTTONS_SIZE, 0>;
+    friend class detail::base_Joystick<Joystick, BUTTONS_SIZE, 0, IS_PULL_UP, PROFILES, POLICY>;
+    friend class detail::base_Joystick_BUTTONS<Joystick, BUTTONS_SIZE, 0, IS_PULL_UP, POLICY>;
+    friend class detail::base_Joystick_POTS<Joystick, BUTTONS_SIZE, 0, PROFILES, POLICY>;
 
     const uint_fast8_t (&BUTTONS)[BUTTONS_SIZE];
 
     void determine_print()
     {
-        switch (Serial.read())
+        switch (POLICY::console().read())
         {
             case 48: //0
-                this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, 0, IS_PULL_UP>::*)()>(&Joystick::template print_buttons<BUTTONS_SIZE, 0>);
+                this->print_ = static_cast<void (detail::base_Joystick<Joystick, BUTTONS_SIZE, 0, IS_PULL_UP, PROFILES, POLICY>::*)()>(&Joystick::template print_buttons<BUTTONS_SIZE, 0>);
                 break;
             case 49: //1
-                Serial.println("There are no potentiometers!");
-                Serial.println("Invalid input.");
-                Serial.println();
+                POLICY::console().println("There are no potentiometers!");
+                POLICY::console().println("Invalid input.");
+                POLICY::console().println();
                 break;
             default:
-                Serial.println("Invalid input.");
-                Serial.println();
+                POLICY::console().println("Invalid input.");
+                POLICY::console().println();
                 break;
         }
     }
@@ -527,6 +2483,7 @@ public:
     void setup()
     {
         this->setup_buttons();
+        this->setup_encoders();
     }
 
     //Read button values
@@ -534,6 +2491,7 @@ public:
     {
         memset(this->data_buttons, 0, sizeof(this->data_buttons));
         this->read_buttons();
+        this->read_encoders();
     }
 
     //Designed for Serial Plotter
@@ -546,53 +2504,62 @@ public:
     {
         this->send_data();
     }
+
+    //Frames skipped by send as the port was busy
+    uint_fast32_t dropped_frames() const
+    {
+        return this->drops;
+    }
 };
 
-template <size_t POTS_SIZE, bool IS_PULL_UP>
-class Joystick<0, POTS_SIZE, IS_PULL_UP> : private detail::base_Joystick<Joystick<0, POTS_SIZE, IS_PULL_UP>, 0, POTS_SIZE, IS_PULL_UP>
+template <size_t POTS_SIZE, bool IS_PULL_UP, size_t PROFILES, class POLICY>
+class Joystick<0, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY> : private detail::base_Joystick<Joystick<0, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>, 0, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>
 {
 private:
-    friend class detail::base_Joystick<Joystick, 0, POTS_SIZE, IS_PULL_UP>;
-    friend class detail::base_Joystick_BUTTONS<Joystick, 0, POTS_SIZE, IS_PULL_UP>;
-    friend class detail::base_Joystick_POTS<Joystick, 0, POTS_SIZE>;
+    friend class detail::base_Joystick<Joystick, 0, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>;
+    friend class detail::base_Joystick_BUTTONS<Joystick, 0, POTS_SIZE, IS_PULL_UP, POLICY>;
+    friend class detail::base_Joystick_POTS<Joystick, 0, POTS_SIZE, PROFILES, POLICY>;
 
     const uint_fast8_t (&POTS)[POTS_SIZE];
-    uint_fast16_t (&CALIBRATION)[POTS_SIZE * 2];
+    typename POLICY::storage_type (&CALIBRATION)[POTS_SIZE * 2 * PROFILES];
 
     void determine_print()
     {
-        switch (Serial.read())
+        switch (POLICY::console().read())
         {
             case 48: //0
-                Serial.println("There are no buttons!");
-                Serial.println("Invalid input.");
-                Serial.println();
+                POLICY::console().println("There are no buttons!");
+                POLICY::console().println("Invalid input.");
+                POLICY::console().println();
                 break;
             case 49: //1
-                this->print_ = static_cast<void (detail::base_Joystick<Joystick, 0, POTS_SIZE, IS_PULL_UP>::*)()>(&Joystick::template print_pots<0, POTS_SIZE>);
+                this->print_ = static_cast<void (detail::base_Joystick<Joystick, 0, POTS_SIZE, IS_PULL_UP, PROFILES, POLICY>::*)()>(&Joystick::template print_pots<0, POTS_SIZE>);
                 break;
             default:
-                Serial.println("Invalid input.");
-                Serial.println();
+                POLICY::console().println("Invalid input.");
+                POLICY::console().println();
                 break;
         }
     }
 
 public:
-    Joystick(decltype(nullptr), const uint_fast8_t (&POTS)[POTS_SIZE], uint_fast16_t (&CALIBRATION)[POTS_SIZE * 2])
+    Joystick(decltype(nullptr), const uint_fast8_t (&POTS)[POTS_SIZE], typename POLICY::storage_type (&CALIBRATION)[POTS_SIZE * 2 * PROFILES])
         : POTS(POTS), CALIBRATION(CALIBRATION)
     {}
 
     void setup()
     {
         this->setup_pots();
+        this->setup_encoders();
     }
 
     //Read potentiometer values
     void read()
     {
-        memset(this->data_pots, 0, sizeof(this->data_pots));
+        this->start_pots();
         this->read_pots();
+        this->read_thresholds();
+        this->read_encoders();
     }
     
     //Designed for Serial Plotter
@@ -605,4 +2572,16 @@ public:
     {
         this->send_data();
     }
+
+    //Frames skipped by send as the port was busy
+    uint_fast32_t dropped_frames() const
+    {
+        return this->drops;
+    }
+
+    //Switch to another set of calibration values
+    void select_profile(const size_t index)
+    {
+        this->select_pots_profile(index);
+    }
 };
\ No newline at end of file
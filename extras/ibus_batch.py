@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Decodes the frames sent by the Joystick library and benchmarks batch frames.
+
+Frames start with their length and a command byte, and end with a checksum of 0xFFFF minus every other byte:
+    0x40 [Channel_1L][Channel_1H]...                                  one sample, read by vJoySerialFeeder
+    0x41 [Delta_1L][Delta_1H][Channel_1L][Channel_1H]... per sample   batch_samples samples, sent when batch_samples > 1
+Deltas are the microseconds elapsed since the previous sample, saturated to 0xFFFF.
+
+Usage:
+    ibus_batch.py benchmark --channels 3 --batch 8
+    ibus_batch.py capture --port COM3 --baud 115200 --channels 3 --seconds 5
+"""
+
+import argparse
+import struct
+import time
+
+SINGLE = 0x40
+BATCH = 0x41
+
+
+def checksum(frame):
+    return (0xFFFF - sum(frame)) & 0xFFFF
+
+
+def encode(samples, channel_bytes=2):
+    """Encodes [(delta, [channels...]), ...] into one frame, a batch frame when holding more than one sample."""
+    fmt = "<" + ("H" if channel_bytes == 2 else "I") * len(samples[0][1])
+
+    if len(samples) == 1:
+        body = bytes([0, SINGLE]) + struct.pack(fmt, *samples[0][1])
+    else:
+        body = bytes([0, BATCH]) + b"".join(struct.pack("<H", min(delta, 0xFFFF)) + struct.pack(fmt, *channels) for delta, channels in samples)
+
+    if len(body) + 2 > 0xFF:
+        raise ValueError("frame longer than 255 bytes")
+
+    frame = bytearray(body)
+    frame[0] = len(frame) + 2
+
+    return bytes(frame + struct.pack("<H", checksum(frame)))
+
+
+class Decoder:
+    """Splits a byte stream into samples, resynchronising on bad frames."""
+
+    def __init__(self, channels, channel_bytes=2):
+        self.channels = channels
+        self.channel_bytes = channel_bytes
+        self.data_size = channels * channel_bytes
+        self.buffer = bytearray()
+        self.bad = 0
+        self.time = 0
+
+    def _channels(self, data):
+        return [int.from_bytes(data[i:i + self.channel_bytes], "little") for i in range(0, self.data_size, self.channel_bytes)]
+
+    def _frame(self, frame):
+        command, body = frame[1], frame[2:-2]
+
+        if command == SINGLE and len(body) == self.data_size:
+            return [(None, self._channels(body))]
+
+        if command == BATCH and len(body) % (2 + self.data_size) == 0:
+            samples = []
+            for i in range(0, len(body), 2 + self.data_size):
+                self.time += body[i] | (body[i + 1] << 8)
+                samples.append((self.time, self._channels(body[i + 2:i + 2 + self.data_size])))
+            return samples
+
+        return None
+
+    def feed(self, data):
+        """Returns the (microseconds, channels) samples completed by data; microseconds is None for single frames."""
+        self.buffer += data
+        samples = []
+
+        while len(self.buffer) >= 4:
+            length = self.buffer[0]
+
+            if length < 4 or self.buffer[1] not in (SINGLE, BATCH):
+                del self.buffer[0]
+                self.bad += 1
+                continue
+
+            if len(self.buffer) < length:
+                break
+
+            frame = bytes(self.buffer[:length])
+            decoded = None
+
+            if struct.unpack_from("<H", frame, length - 2)[0] == checksum(frame[:-2]):
+                decoded = self._frame(frame)
+
+            if decoded is None:
+                del self.buffer[0]
+                self.bad += 1
+                continue
+
+            del self.buffer[:length]
+            samples += decoded
+
+        return samples
+
+
+def benchmark(args):
+    samples = [(500, [(n * 7 + c) & 0xFFF for c in range(args.channels)]) for n in range(args.samples)]
+
+    for batch in sorted({1, args.batch}):
+        stream = b"".join(encode(samples[i:i + batch], args.channel_bytes) for i in range(0, len(samples) - batch + 1, batch))
+        decoder = Decoder(args.channels, args.channel_bytes)
+
+        start = time.perf_counter()
+        decoded = decoder.feed(stream)
+        elapsed = time.perf_counter() - start
+
+        per_sample = len(stream) / len(decoded)
+        link = args.baud / 10 / per_sample
+
+        print("batch %3d: %6.2f bytes/sample, %8.0f samples/s at %d baud, decoded %8.0f samples/s, %d bad" % (batch, per_sample, link, args.baud, len(decoded) / elapsed, decoder.bad))
+
+
+def capture(args):
+    import serial
+
+    decoder = Decoder(args.channels, args.channel_bytes)
+    count = 0
+    first = last = None
+
+    with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+        end = time.monotonic() + args.seconds
+
+        while time.monotonic() < end:
+            for stamp, channels in decoder.feed(port.read(port.in_waiting or 1)):
+                count += 1
+                if stamp is not None:
+                    first = stamp if first is None else first
+                    last = stamp
+                if args.verbose:
+                    print(stamp, channels)
+
+    print("%d samples in %.1f s, %d bad bytes" % (count, args.seconds, decoder.bad))
+    if first is not None and last != first:
+        print("sample rate from timestamps: %.1f Hz" % ((count - 1) * 1e6 / (last - first)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=("benchmark", "capture"))
+    parser.add_argument("--channels", type=int, required=True, help="channels per sample, button words followed by potentiometers")
+    parser.add_argument("--channel-bytes", type=int, default=2, choices=(2, 4), help="sizeof(storage_type) on the board")
+    parser.add_argument("--batch", type=int, default=8, help="batch_samples compared with single frames")
+    parser.add_argument("--samples", type=int, default=100000)
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--port")
+    parser.add_argument("--seconds", type=float, default=5)
+    parser.add_argument("--verbose", action="store_true")
+    args = parser.parse_args()
+
+    if args.mode == "benchmark":
+        benchmark(args)
+    else:
+        capture(args)
+
+
+if __name__ == "__main__":
+    main()